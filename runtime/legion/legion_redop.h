@@ -72,6 +72,7 @@ namespace Legion {
 
     static const int8_t identity = 0;
     static constexpr int REDOP_ID = LEGION_REDOP_SUM_INT8;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -87,6 +88,7 @@ namespace Legion {
 
     static const int16_t identity = 0;
     static constexpr int REDOP_ID = LEGION_REDOP_SUM_INT16;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -102,6 +104,7 @@ namespace Legion {
 
     static const int32_t identity = 0;
     static constexpr int REDOP_ID = LEGION_REDOP_SUM_INT32;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -117,6 +120,7 @@ namespace Legion {
 
     static const int64_t identity = 0;
     static constexpr int REDOP_ID = LEGION_REDOP_SUM_INT64;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -132,6 +136,7 @@ namespace Legion {
 
     static const uint8_t identity = 0;
     static constexpr int REDOP_ID = LEGION_REDOP_SUM_UINT8;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -147,6 +152,7 @@ namespace Legion {
 
     static const uint16_t identity = 0;
     static constexpr int REDOP_ID = LEGION_REDOP_SUM_UINT16;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -162,6 +168,7 @@ namespace Legion {
 
     static const uint32_t identity = 0;
     static constexpr int REDOP_ID = LEGION_REDOP_SUM_UINT32;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -177,6 +184,7 @@ namespace Legion {
 
     static const uint64_t identity = 0;
     static constexpr int REDOP_ID = LEGION_REDOP_SUM_UINT64;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -209,6 +217,7 @@ namespace Legion {
 
     static const float identity;
     static constexpr int REDOP_ID = LEGION_REDOP_SUM_FLOAT32;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -224,6 +233,7 @@ namespace Legion {
 
     static const double identity;
     static constexpr int REDOP_ID = LEGION_REDOP_SUM_FLOAT64;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -520,6 +530,7 @@ namespace Legion {
 
     static const int8_t identity = 1;
     static constexpr int REDOP_ID = LEGION_REDOP_PROD_INT8;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -535,6 +546,7 @@ namespace Legion {
 
     static const int16_t identity = 1;
     static constexpr int REDOP_ID = LEGION_REDOP_PROD_INT16;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -550,6 +562,7 @@ namespace Legion {
 
     static const int32_t identity = 1;
     static constexpr int REDOP_ID = LEGION_REDOP_PROD_INT32;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -565,6 +578,7 @@ namespace Legion {
 
     static const int64_t identity = 1;
     static constexpr int REDOP_ID = LEGION_REDOP_PROD_INT64;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -580,6 +594,7 @@ namespace Legion {
 
     static const uint8_t identity = 1;
     static constexpr int REDOP_ID = LEGION_REDOP_PROD_UINT8;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -595,6 +610,7 @@ namespace Legion {
 
     static const uint16_t identity = 1;
     static constexpr int REDOP_ID = LEGION_REDOP_PROD_UINT16;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -610,6 +626,7 @@ namespace Legion {
 
     static const uint32_t identity = 1;
     static constexpr int REDOP_ID = LEGION_REDOP_PROD_UINT32;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -625,6 +642,7 @@ namespace Legion {
 
     static const uint64_t identity = 1;
     static constexpr int REDOP_ID = LEGION_REDOP_PROD_UINT64;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -657,6 +675,7 @@ namespace Legion {
 
     static const float identity;
     static constexpr int REDOP_ID = LEGION_REDOP_PROD_FLOAT32;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -672,6 +691,7 @@ namespace Legion {
 
     static const double identity;
     static constexpr int REDOP_ID = LEGION_REDOP_PROD_FLOAT64;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -949,6 +969,7 @@ namespace Legion {
 
     static const int8_t identity = SCHAR_MIN;
     static constexpr int REDOP_ID = LEGION_REDOP_MAX_INT8;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -964,6 +985,7 @@ namespace Legion {
 
     static const int16_t identity = SHRT_MIN;
     static constexpr int REDOP_ID = LEGION_REDOP_MAX_INT16;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -979,6 +1001,7 @@ namespace Legion {
 
     static const int32_t identity = INT_MIN;
     static constexpr int REDOP_ID = LEGION_REDOP_MAX_INT32;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -994,6 +1017,7 @@ namespace Legion {
 
     static const int64_t identity = LLONG_MIN;
     static constexpr int REDOP_ID = LEGION_REDOP_MAX_INT64;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -1009,6 +1033,7 @@ namespace Legion {
 
     static const uint8_t identity = 0;
     static constexpr int REDOP_ID = LEGION_REDOP_MAX_UINT8;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -1024,6 +1049,7 @@ namespace Legion {
 
     static const uint16_t identity = 0;
     static constexpr int REDOP_ID = LEGION_REDOP_MAX_UINT16;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -1039,6 +1065,7 @@ namespace Legion {
 
     static const uint32_t identity = 0;
     static constexpr int REDOP_ID = LEGION_REDOP_MAX_UINT32;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -1054,6 +1081,7 @@ namespace Legion {
 
     static const uint64_t identity = 0;
     static constexpr int REDOP_ID = LEGION_REDOP_MAX_UINT64;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -1086,6 +1114,7 @@ namespace Legion {
 
     static const float identity;
     static constexpr int REDOP_ID = LEGION_REDOP_MAX_FLOAT32;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -1101,6 +1130,7 @@ namespace Legion {
 
     static const double identity;
     static constexpr int REDOP_ID = LEGION_REDOP_MAX_FLOAT64;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -1137,6 +1167,7 @@ namespace Legion {
 
     static const int8_t identity = SCHAR_MAX;
     static constexpr int REDOP_ID = LEGION_REDOP_MIN_INT8;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -1152,6 +1183,7 @@ namespace Legion {
 
     static const int16_t identity = SHRT_MAX;
     static constexpr int REDOP_ID = LEGION_REDOP_MIN_INT16;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -1167,6 +1199,7 @@ namespace Legion {
 
     static const int32_t identity = INT_MAX;
     static constexpr int REDOP_ID = LEGION_REDOP_MIN_INT32;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -1182,6 +1215,7 @@ namespace Legion {
 
     static const int64_t identity = LLONG_MAX;
     static constexpr int REDOP_ID = LEGION_REDOP_MIN_INT64;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -1197,6 +1231,7 @@ namespace Legion {
 
     static const uint8_t identity = UCHAR_MAX;
     static constexpr int REDOP_ID = LEGION_REDOP_MIN_UINT8;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -1212,6 +1247,7 @@ namespace Legion {
 
     static const uint16_t identity = USHRT_MAX;
     static constexpr int REDOP_ID = LEGION_REDOP_MIN_UINT16;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -1227,6 +1263,7 @@ namespace Legion {
 
     static const uint32_t identity = UINT_MAX;
     static constexpr int REDOP_ID = LEGION_REDOP_MIN_UINT32;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -1242,6 +1279,7 @@ namespace Legion {
 
     static const uint64_t identity = ULLONG_MAX;
     static constexpr int REDOP_ID = LEGION_REDOP_MIN_UINT64;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -1274,6 +1312,7 @@ namespace Legion {
 
     static const float identity;
     static constexpr int REDOP_ID = LEGION_REDOP_MIN_FLOAT32;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -1289,6 +1328,7 @@ namespace Legion {
 
     static const double identity;
     static constexpr int REDOP_ID = LEGION_REDOP_MIN_FLOAT64;
+    static const bool is_vectorizable = true;
 
     template<bool EXCLUSIVE> __CUDA_HD__
     static void apply(LHS &lhs, RHS rhs);
@@ -20,21 +20,28 @@
 #include "realm/mutex.h"
 #include "realm/cmdline.h"
 #include "realm/logging.h"
+#include "realm/runtime_impl.h"
+#include "realm/sampling.h"
 
 #include <math.h>
+#include <algorithm>
 
 namespace Realm {
 
   Realm::Logger log_amhandler("amhandler");
 
   namespace Config {
-    // if true, the number and min/max/avg/stddev duration of handler per
-    //  message type is recorded and printed
+    // if true, the number, total size, queueing delay and min/max/avg/stddev
+    //  duration of handler per message type is recorded, published via
+    //  sampling profiler gauges, and printed at shutdown
     bool profile_activemsg_handlers = false;
 
     // the maximum time we're willing to spend on inline message
     //  handlers
     long long max_inline_message_time = 5000 /* nanoseconds*/;
+
+    // a single lane preserves the ordering of all messages from a sender
+    int activemsg_handler_lanes = 1;
   };
 
 
@@ -89,6 +96,193 @@ namespace Realm {
   }
 
 
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // struct ActiveMessageBatchHeader
+  //
+
+  // a batch's payload is a sequence of records, each followed by the
+  //  message's header and payload (each padded to 8B)
+  struct BatchedMessageRecord {
+    uint32_t msgid;
+    uint32_t header_size;
+    uint64_t payload_size;
+  };
+
+  static inline size_t batch_padded(size_t bytes)
+  {
+    return ((bytes + 7) & ~size_t(7));
+  }
+
+  // steps through the messages in a batch, returning false at the end
+  static bool next_batched_message(const char *& pos, const char *end,
+				   ActiveMessageHandlerTable::MessageID& msgid,
+				   const void *& header, size_t& header_size,
+				   const void *& payload, size_t& payload_size)
+  {
+    if(pos >= end)
+      return false;
+    BatchedMessageRecord rec;
+    memcpy(&rec, pos, sizeof(rec));
+    msgid = rec.msgid;
+    header = pos + sizeof(rec);
+    header_size = rec.header_size;
+    payload = pos + sizeof(rec) + batch_padded(header_size);
+    payload_size = rec.payload_size;
+    pos += (sizeof(rec) + batch_padded(header_size) +
+	    batch_padded(payload_size));
+    assert(pos <= end);
+    return true;
+  }
+
+  struct ActiveMessageBatchHeader {
+    unsigned num_messages;
+
+    // runs the handler for each message in the batch, in order - a batch
+    //  is counted as a single incoming message once all of them are done
+    static void handle_message(NodeID sender,
+			       const ActiveMessageBatchHeader& msg,
+			       const void *data, size_t datalen,
+			       TimeLimit work_until);
+  };
+
+  /*static*/ void ActiveMessageBatchHeader::handle_message(NodeID sender,
+							   const ActiveMessageBatchHeader& msg,
+							   const void *data,
+							   size_t datalen,
+							   TimeLimit work_until)
+  {
+    const char *pos = static_cast<const char *>(data);
+    const char *end = pos + datalen;
+    ActiveMessageHandlerTable::MessageID msgid;
+    const void *header, *payload;
+    size_t header_size, payload_size;
+    unsigned count = 0;
+    while(next_batched_message(pos, end, msgid, header, header_size,
+			       payload, payload_size)) {
+      ActiveMessageHandlerTable::HandlerEntry *handler =
+	activemsg_handler_table.lookup_message_handler(msgid);
+      if(handler->handler != 0)
+	(handler->handler)(sender, header, payload, payload_size, work_until);
+      else
+	(handler->handler_notimeout)(sender, header, payload, payload_size);
+      count++;
+    }
+    assert(count == msg.num_messages);
+  }
+
+  ActiveMessageHandlerReg<ActiveMessageBatchHeader> active_message_batch_handler;
+
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class ActiveMessageBatch
+  //
+
+  ActiveMessageBatch::ActiveMessageBatch(NodeID _target,
+					 size_t _max_batch_size /*= 0*/)
+    : target(_target)
+    , max_batch_size(_max_batch_size)
+    , buffer(0)
+    , buffer_size(0)
+    , buffer_used(0)
+    , num_messages(0)
+  {
+    if(max_batch_size == 0) {
+      // batches to ourselves never hit the network, so any size is fine
+      if(target == Network::my_node_id)
+	max_batch_size = 65536;
+      else
+	max_batch_size = ActiveMessage<ActiveMessageBatchHeader>::recommended_max_payload(target,
+											 false /*!with_congestion*/);
+      // very large batches just add latency for the first message
+      max_batch_size = std::max(size_t(1024),
+				std::min(max_batch_size, size_t(65536)));
+    }
+  }
+
+  ActiveMessageBatch::~ActiveMessageBatch(void)
+  {
+    commit();
+    free(buffer);
+  }
+
+  size_t ActiveMessageBatch::pending_messages(void) const
+  {
+    return num_messages;
+  }
+
+  void ActiveMessageBatch::append_message(ActiveMessageHandlerTable::MessageID msgid,
+					  const void *header, size_t header_size,
+					  const void *payload, size_t payload_size)
+  {
+    size_t bytes = (sizeof(BatchedMessageRecord) +
+		    batch_padded(header_size) +
+		    batch_padded(payload_size));
+
+    // send what we've got if this message won't fit - a message that's
+    //  bigger than a batch still gets sent (as a batch of one)
+    if((num_messages > 0) && ((buffer_used + bytes) > max_batch_size))
+      commit();
+
+    if((buffer_used + bytes) > buffer_size) {
+      size_t new_size = std::max(buffer_used + bytes,
+				 std::min(max_batch_size,
+					  std::max(buffer_size * 2,
+						   size_t(1024))));
+      buffer = static_cast<char *>(realloc(buffer, new_size));
+      assert(buffer != 0);
+      buffer_size = new_size;
+    }
+
+    char *pos = buffer + buffer_used;
+    BatchedMessageRecord rec;
+    rec.msgid = msgid;
+    rec.header_size = header_size;
+    rec.payload_size = payload_size;
+    memcpy(pos, &rec, sizeof(rec));
+    pos += sizeof(rec);
+    memcpy(pos, header, header_size);
+    pos += batch_padded(header_size);
+    if(payload_size > 0)
+      memcpy(pos, payload, payload_size);
+
+    buffer_used += bytes;
+    num_messages++;
+  }
+
+  void ActiveMessageBatch::commit(void)
+  {
+    if(num_messages == 0)
+      return;
+
+    if(target == Network::my_node_id) {
+      // the network doesn't send messages to ourselves, so queue it
+      //  directly (never inline - we don't know what locks the caller is
+      //  holding)
+      ActiveMessageBatchHeader hdr;
+      hdr.num_messages = num_messages;
+      get_runtime()->message_manager->add_local_message(activemsg_handler_table.lookup_message_id<ActiveMessageBatchHeader>(),
+							&hdr, sizeof(hdr),
+							buffer, buffer_used);
+    } else {
+      ActiveMessage<ActiveMessageBatchHeader> amsg(target, buffer_used);
+      amsg->num_messages = num_messages;
+      amsg.add_payload(buffer, buffer_used, PAYLOAD_COPY);
+      amsg.commit();
+    }
+
+    buffer_used = 0;
+    num_messages = 0;
+  }
+
+  void ActiveMessageBatch::cancel(void)
+  {
+    buffer_used = 0;
+    num_messages = 0;
+  }
+
+
   ////////////////////////////////////////////////////////////////////////
   //
   // struct ActiveMessageHandlerStats
@@ -96,6 +290,7 @@ namespace Realm {
 
   ActiveMessageHandlerStats::ActiveMessageHandlerStats(void)
     : count(0), sum(0), sum2(0), minval(~size_t(0)), maxval(0)
+    , bytes(0), queued_sum(0), queued_max(0)
   {}
 
   void ActiveMessageHandlerStats::record(long long t_start, long long t_end)
@@ -109,6 +304,44 @@ namespace Realm {
     sum2.fetch_add(val * val); // TODO: smarter math to avoid overflow
   }
 
+  void ActiveMessageHandlerStats::record_message(size_t msg_bytes,
+						 long long queue_delay)
+  {
+    size_t delay = (queue_delay > 0) ? queue_delay : 0;
+    bytes.fetch_add(msg_bytes);
+    queued_sum.fetch_add(delay);
+    queued_max.fetch_max(delay);
+  }
+
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // struct ActiveMessageHandlerGauges
+  //
+
+  struct ActiveMessageHandlerGauges {
+    ActiveMessageHandlerGauges(const std::string& name);
+
+    ProfilingGauges::EventCounter<unsigned long long> messages, bytes;
+    ProfilingGauges::AbsoluteRangeGauge<long long> queue_delay, handler_time;
+  };
+
+  static std::string handler_gauge_name(const char *metric, const char *name)
+  {
+    // gauge names are truncated in the sample file, so drop the namespace
+    //  that nearly every handler shares
+    if(!strncmp(name, "Realm::", 7))
+      name += 7;
+    return std::string("realm/am/") + metric + "/" + name;
+  }
+
+  ActiveMessageHandlerGauges::ActiveMessageHandlerGauges(const std::string& name)
+    : messages(handler_gauge_name("count", name.c_str()))
+    , bytes(handler_gauge_name("bytes", name.c_str()))
+    , queue_delay(handler_gauge_name("queue delay", name.c_str()))
+    , handler_time(handler_gauge_name("handler time", name.c_str()))
+  {}
+
 
   ////////////////////////////////////////////////////////////////////////
   //
@@ -121,6 +354,31 @@ namespace Realm {
   ActiveMessageHandlerTable::~ActiveMessageHandlerTable(void)
   {}
 
+  void ActiveMessageHandlerTable::record_message_profile(HandlerEntry *entry,
+							 size_t msg_bytes,
+							 long long queue_delay,
+							 long long t_start,
+							 long long t_end)
+  {
+    entry->stats.record_message(msg_bytes, queue_delay);
+
+    // gauges are created lazily so that only handlers that actually see
+    //  traffic show up in the sampling profile
+    ActiveMessageHandlerGauges *gauges = entry->gauges.load_acquire();
+    if(!gauges) {
+      ActiveMessageHandlerGauges *new_gauges = new ActiveMessageHandlerGauges(entry->name);
+      if(entry->gauges.compare_exchange(gauges, new_gauges))
+	gauges = new_gauges;
+      else
+	delete new_gauges;  // somebody else won the race
+    }
+
+    gauges->messages += 1;
+    gauges->bytes += msg_bytes;
+    gauges->queue_delay = queue_delay;
+    gauges->handler_time = t_end - t_start;
+  }
+
   ActiveMessageHandlerTable::HandlerEntry *ActiveMessageHandlerTable::lookup_message_handler(ActiveMessageHandlerTable::MessageID id)
   {
     assert(id < handlers.size());
@@ -141,27 +399,51 @@ namespace Realm {
     handlers[id].stats.record(t_start, t_end);
   }
 
+  static bool handler_time_greater(const std::pair<size_t, size_t>& a,
+				   const std::pair<size_t, size_t>& b)
+  {
+    return ((a.first > b.first) ||
+	    ((a.first == b.first) && (a.second < b.second)));
+  }
+
   void ActiveMessageHandlerTable::report_message_handler_stats()
   {
     if(Config::profile_activemsg_handlers) {
-      for(size_t i = 0; i < handlers.size(); i++) {
+      // report the handlers that took the most total time first
+      std::vector<std::pair<size_t, size_t> > order;
+      for(size_t i = 0; i < handlers.size(); i++)
+	if(handlers[i].stats.count.load() > 0)
+	  order.push_back(std::make_pair(handlers[i].stats.sum.load(), i));
+      std::sort(order.begin(), order.end(), handler_time_greater);
+
+      for(size_t j = 0; j < order.size(); j++) {
+	size_t i = order[j].second;
 	const ActiveMessageHandlerStats& stats = handlers[i].stats;
 	size_t count = stats.count.load();
-	if(count == 0)
-	  continue;
-
 	size_t sum = stats.sum.load();
 	size_t sum2 = stats.sum2.load();
 	size_t minval = stats.minval.load();
 	size_t maxval = stats.maxval.load();
 	double avg = double(sum) / double(count);
 	double stddev = sqrt((double(sum2) / double(count)) - (avg * avg));
+	double qavg = double(stats.queued_sum.load()) / double(count);
 	log_amhandler.print() << "handler " << i << ": " << handlers[i].name
 			      << " count=" << count
+			      << " bytes=" << stats.bytes.load()
+			      << " total=" << sum
 			      << " avg=" << avg
 			      << " dev=" << stddev
 			      << " min=" << minval
-			      << " max=" << maxval;
+			      << " max=" << maxval
+			      << " qavg=" << qavg
+			      << " qmax=" << stats.queued_max.load();
+      }
+
+      // this happens after the sampling profiler has been shut down, so
+      //  the gauges can go away now
+      for(size_t i = 0; i < handlers.size(); i++) {
+	delete handlers[i].gauges.load();
+	handlers[i].gauges.store(0);
       }
     }
   }
@@ -191,6 +473,7 @@ namespace Realm {
       // at least one of the two above must be non-null
       assert((e.handler != 0) || (e.handler_notimeout != 0));
       e.handler_inline = nextreg->get_handler_inline();
+      e.gauges.store(0);
       handlers.push_back(e);
     }
 
@@ -324,6 +607,48 @@ namespace Realm {
     }
   }
 
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // struct IncomingMessageManager::TodoList
+  //
+
+  void IncomingMessageManager::TodoList::init(int _max_entries)
+  {
+    max_entries = _max_entries;
+    entries = new int[max_entries + 1];  // an extra entry to distinguish full from empty
+    oldest = newest = 0;
+  }
+
+  void IncomingMessageManager::TodoList::destroy()
+  {
+    delete[] entries;
+  }
+
+  bool IncomingMessageManager::TodoList::empty() const
+  {
+    return (oldest == newest);
+  }
+
+  void IncomingMessageManager::TodoList::push(int queue)
+  {
+    entries[newest] = queue;
+    newest++;
+    if(newest > max_entries)
+      newest = 0;
+    assert(newest != oldest);  // should never wrap around
+  }
+
+  int IncomingMessageManager::TodoList::pop()
+  {
+    assert(oldest != newest);
+    int queue = entries[oldest];
+    oldest++;
+    if(oldest > max_entries)
+      oldest = 0;
+    return queue;
+  }
+
+
   ////////////////////////////////////////////////////////////////////////
   //
   // class IncomingMessageManager
@@ -340,12 +665,16 @@ namespace Realm {
     : BackgroundWorkItem("activemsg handler")
     , nodes(_nodes), dedicated_threads(_dedicated_threads)
     , sleeper_count(0)
+    , num_lanes(Config::activemsg_handler_lanes)
+    , num_queues(_nodes * num_lanes)
     , bgwork_requested(false)
     , shutdown_flag(0)
+    , cheap_run_length(0)
     , handlers_active(0)
     , drain_pending(false)
     , drain_min_count(0)
     , total_messages_handled(0)
+    , local_messages_added(0)
     , condvar(mutex)
     , drain_condvar(mutex)
     , available_blocks(0)
@@ -353,16 +682,18 @@ namespace Realm {
     , cfg_max_available_blocks(10)
     , cfg_message_block_size(1048576 - 32) // 1MB - space for heap metadata
   {
-    heads = new Message *[nodes];
-    tails = new Message **[nodes];
-    in_handler = new bool[nodes];
-    for(int i = 0; i < nodes; i++) {
+    assert(num_lanes >= 1);
+    heads = new Message *[num_queues];
+    tails = new Message **[num_queues];
+    in_handler = new bool[num_queues];
+    for(int i = 0; i < num_queues; i++) {
       heads[i] = 0;
       tails[i] = 0;
       in_handler[i] = false;
     }
-    todo_list = new int[nodes + 1];  // an extra entry to distinguish full from empty
-    todo_oldest = todo_newest = 0;
+    todo_list.init(num_queues);
+    // the cheap lane only exists if there's more than one
+    cheap_todo_list.init((num_lanes > 1) ? nodes : 0);
 
     if(dedicated_threads > 0)
       core_rsrv = new Realm::CoreReservation("AM handlers", crs,
@@ -379,7 +710,8 @@ namespace Realm {
     delete[] heads;
     delete[] tails;
     delete[] in_handler;
-    delete[] todo_list;
+    todo_list.destroy();
+    cheap_todo_list.destroy();
 
     MessageBlock::free_block(current_block);
     if(available_blocks)
@@ -418,6 +750,10 @@ namespace Realm {
 	if(Config::profile_activemsg_handlers) {
 	  long long t_end = Clock::current_time_in_nanoseconds();
 	  handler->stats.record(t_start, t_end);
+	  activemsg_handler_table.record_message_profile(handler,
+							 hdr_size + payload_size,
+							 0 /*not queued*/,
+							 t_start, t_end);
 	}
 	if(payload_mode == PAYLOAD_FREE)
 	  free(const_cast<void *>(payload));
@@ -426,8 +762,8 @@ namespace Realm {
           AutoLock<> al(mutex);
           total_messages_handled += 1;
           if(drain_pending &&
-             (todo_oldest == todo_newest) && (handlers_active == 0) &&
-             (total_messages_handled >= drain_min_count)) {
+             todo_empty() && (handlers_active == 0) &&
+             drain_count_reached()) {
             drain_pending = false;
             drain_condvar.broadcast();
           }
@@ -437,6 +773,7 @@ namespace Realm {
     }
 
     // can't handle inline - need to create a Message object for it
+    int queue = queue_index(sender, msgid, handler);
 
     mutex.lock();
 
@@ -498,6 +835,8 @@ namespace Realm {
       msg->callback_fnptr = callback_fnptr;
       msg->callback_data1 = callback_data1;
       msg->callback_data2 = callback_data2;
+      msg->t_enqueue = (Config::profile_activemsg_handlers ?
+			  Clock::current_time_in_nanoseconds() : 0);
 
       if(hdr_mode == PAYLOAD_COPY)
 	memcpy(msg->hdr, hdr, hdr_size);
@@ -516,25 +855,21 @@ namespace Realm {
       msg->payload_needs_free = (payload_mode == PAYLOAD_FREE);
     }
 
-    if(heads[sender]) {
+    if(heads[queue]) {
       // tack this on to the existing list
-      assert(tails[sender]);
-      *(tails[sender]) = msg;
-      tails[sender] = &(msg->next_msg);
+      assert(tails[queue]);
+      *(tails[queue]) = msg;
+      tails[queue] = &(msg->next_msg);
     } else {
-      // this starts a list, and the node needs to be added to the todo list
-      heads[sender] = msg;
-      tails[sender] = &(msg->next_msg);
-
-      // enqueue if this sender isn't currently being handled
-      if(!in_handler[sender]) {
-	bool was_empty = todo_oldest == todo_newest;
-
-	todo_list[todo_newest] = sender;
-	todo_newest++;
-	if(todo_newest > nodes)
-	  todo_newest = 0;
-	assert(todo_newest != todo_oldest);  // should never wrap around
+      // this starts a list, and the queue needs to be added to the todo list
+      heads[queue] = msg;
+      tails[queue] = &(msg->next_msg);
+
+      // enqueue if this queue isn't currently being handled
+      if(!in_handler[queue]) {
+	bool was_empty = todo_empty();
+
+	todo_list_for_queue(queue).push(queue);
 	if(sleeper_count > 0)
 	  condvar.broadcast();  // wake up any sleepers
 
@@ -549,6 +884,27 @@ namespace Realm {
     return false;  // not handled right away
   }
 
+  void IncomingMessageManager::add_local_message(ActiveMessageHandlerTable::MessageID msgid,
+						 const void *hdr,
+						 size_t hdr_size,
+						 const void *payload,
+						 size_t payload_size)
+  {
+    // count it before it can possibly be handled so that the drain count
+    //  is never overestimated
+    {
+      AutoLock<> al(mutex);
+      local_messages_added += 1;
+    }
+
+    bool handled = add_incoming_message(Network::my_node_id, msgid,
+					hdr, hdr_size, PAYLOAD_COPY,
+					payload, payload_size, PAYLOAD_COPY,
+					0, 0, 0,
+					TimeLimit::relative(0));
+    assert(!handled);
+  }
+
   void IncomingMessageManager::start_handler_threads(size_t stack_size)
   {
     handler_threads.resize(dedicated_threads);
@@ -563,14 +919,52 @@ namespace Realm {
 													     *core_rsrv);
   }
 
+  int IncomingMessageManager::queue_index(NodeID sender,
+					  ActiveMessageHandlerTable::MessageID msgid,
+					  const ActiveMessageHandlerTable::HandlerEntry *handler) const
+  {
+    if(num_lanes == 1)
+      return sender;
+
+    // handlers with inline variants are cheap - they get lane 0 to
+    //  themselves so they never wait behind expensive handlers
+    int lane;
+    if(handler->handler_inline != 0)
+      lane = 0;
+    else
+      lane = 1 + (msgid % (num_lanes - 1));
+    return (sender * num_lanes) + lane;
+  }
+
+  IncomingMessageManager::TodoList& IncomingMessageManager::todo_list_for_queue(int queue)
+  {
+    if((num_lanes > 1) && ((queue % num_lanes) == 0))
+      return cheap_todo_list;
+    else
+      return todo_list;
+  }
+
+  bool IncomingMessageManager::todo_empty() const
+  {
+    return (todo_list.empty() && cheap_todo_list.empty());
+  }
+
+  bool IncomingMessageManager::drain_count_reached() const
+  {
+    // local messages are included in total_messages_handled, but the
+    //  network never counted them as received - this is exact once all
+    //  local messages have been handled, and conservative before that
+    return (total_messages_handled >= (drain_min_count + local_messages_added));
+  }
+
   // stalls caller until all incoming messages have been handled
   void IncomingMessageManager::drain_incoming_messages(size_t min_messages_handled)
   {
     AutoLock<> al(mutex);
 
-    while((todo_oldest != todo_newest) || (handlers_active > 0) ||
-          (total_messages_handled < min_messages_handled)) {
-      drain_min_count = min_messages_handled;
+    drain_min_count = min_messages_handled;
+    while(!todo_empty() || (handlers_active > 0) ||
+          !drain_count_reached()) {
       drain_pending = true;
       drain_condvar.wait();
     }
@@ -604,7 +998,7 @@ namespace Realm {
   {
     AutoLock<> al(mutex);
 
-    while(todo_oldest == todo_newest) {
+    while(todo_empty()) {
       // todo list is empty
       if(shutdown_flag || !wait)
 	return -1;
@@ -617,67 +1011,71 @@ namespace Realm {
       sleeper_count -= 1;
     }
 
-    // pop the oldest entry off the todo list
-    int sender = todo_list[todo_oldest];
-    todo_oldest++;
-    if(todo_oldest > nodes)
-      todo_oldest = 0;
-    head = heads[sender];
-    tail = tails[sender];
-    heads[sender] = 0;
-    tails[sender] = 0;
-    in_handler[sender] = true;
+    // pop the oldest entry off the todo list, favoring the cheap lane -
+    //  after a run of cheap queues, an expensive one gets a turn if any are
+    //  waiting
+    static const int MAX_CHEAP_RUN_LENGTH = 4;
+    int queue;
+    if(!cheap_todo_list.empty() &&
+       (todo_list.empty() || (cheap_run_length < MAX_CHEAP_RUN_LENGTH))) {
+      queue = cheap_todo_list.pop();
+      cheap_run_length++;
+    } else {
+      queue = todo_list.pop();
+      cheap_run_length = 0;
+    }
+    head = heads[queue];
+    tail = tails[queue];
+    heads[queue] = 0;
+    tails[queue] = 0;
+    in_handler[queue] = true;
     handlers_active++;
 #ifdef DEBUG_INCOMING
-    printf("handling incoming messages from %d\n", sender);
+    printf("handling incoming messages from %d\n", queue / num_lanes);
 #endif
-    // if there are other senders with messages waiting, we can request more
+    // if there are other queues with messages waiting, we can request more
     //  background workers right away
-    if((todo_oldest != todo_newest) && !bgwork_requested.load()) {
+    if(!todo_empty() && !bgwork_requested.load()) {
       bgwork_requested.store(true);
       make_active();
     }
 
-    return sender;
+    return queue;
   }
 
-  bool IncomingMessageManager::return_messages(int sender,
+  bool IncomingMessageManager::return_messages(int queue,
                                                size_t num_handled,
 					       IncomingMessageManager::Message *head,
 					       IncomingMessageManager::Message **tail)
   {
     AutoLock<> al(mutex);
     total_messages_handled += num_handled;
-    in_handler[sender] = false;
+    in_handler[queue] = false;
     handlers_active--;
 
     bool enqueue_needed = false;
-    if(heads[sender] != 0) {
+    if(heads[queue] != 0) {
       // list was non-empty
       if(head != 0) {
 	// prepend on list
-	*tail = heads[sender];
-	heads[sender] = head;
+	*tail = heads[queue];
+	heads[queue] = head;
       }
-      // in in-order mode, we hadn't enqueued this sender, so do that now
+      // in in-order mode, we hadn't enqueued this queue, so do that now
       enqueue_needed = true;
     } else {
       if(head != 0) {
-	heads[sender] = head;
-	tails[sender] = tail;
+	heads[queue] = head;
+	tails[queue] = tail;
 	enqueue_needed = true;
       }
     }
 
     bool now_active = false;
     if(enqueue_needed) {
-      bool was_empty = todo_oldest == todo_newest;
+      bool was_empty = todo_empty();
 
-      todo_list[todo_newest] = sender;
-      todo_newest++;
-      if(todo_newest > nodes)
-	todo_newest = 0;
-      assert(todo_newest != todo_oldest);  // should never wrap around
+      todo_list_for_queue(queue).push(queue);
       if(sleeper_count > 0)
 	condvar.broadcast();  // wake up any sleepers
 
@@ -689,8 +1087,8 @@ namespace Realm {
 
     // was somebody waiting for the queue to go (perhaps temporarily) empty?
     if(drain_pending &&
-       (todo_oldest == todo_newest) && (handlers_active == 0) &&
-       (total_messages_handled >= drain_min_count)) {
+       todo_empty() && (handlers_active == 0) &&
+       drain_count_reached()) {
       drain_pending = false;
       drain_condvar.broadcast();
     }
@@ -708,11 +1106,11 @@ namespace Realm {
 
     Message *current_msg = 0;
     Message **current_tail = 0;
-    int sender = get_messages(current_msg, current_tail, false /*!wait*/);
+    int queue = get_messages(current_msg, current_tail, false /*!wait*/);
 
     // we're here because there was work to do, so an empty list is bad unless
     //  there are also dedicated threads that might have grabbed it
-    if(sender == -1) {
+    if(queue == -1) {
       assert(dedicated_threads > 0);
       return false;
     }
@@ -784,6 +1182,12 @@ namespace Realm {
 
       if(do_profile)
 	current_msg->handler->stats.record(t_start, t_end);
+      if(Config::profile_activemsg_handlers)
+	activemsg_handler_table.record_message_profile(current_msg->handler,
+						       (current_msg->hdr_size +
+							current_msg->payload_size),
+						       t_start - current_msg->t_enqueue,
+						       t_start, t_end);
 #ifdef DETAILED_MESSAGE_TIMING
       detailed_message_timing.record(timing_idx,
 				     current_msg->get_peer(),
@@ -814,7 +1218,7 @@ namespace Realm {
       *skipped_tail = 0;
 
     // put back whatever we had left, if anything - request requeue if needed
-    return return_messages(sender, num_handled, skipped_messages, skipped_tail);
+    return return_messages(queue, num_handled, skipped_messages, skipped_tail);
   }
 
   void IncomingMessageManager::handler_thread_loop(void)
@@ -825,8 +1229,8 @@ namespace Realm {
     while (true) {
       Message *current_msg = 0;
       Message **current_tail = 0;
-      int sender = get_messages(current_msg, current_tail, true /*wait*/);
-      if(sender == -1) {
+      int queue = get_messages(current_msg, current_tail, true /*wait*/);
+      if(queue == -1) {
 #ifdef DEBUG_INCOMING
 	printf("received empty list - assuming shutdown!\n");
 #endif
@@ -867,8 +1271,14 @@ namespace Realm {
 					current_msg->callback_data1,
 					current_msg->callback_data2);
 
-	if(Config::profile_activemsg_handlers)
+	if(Config::profile_activemsg_handlers) {
 	  current_msg->handler->stats.record(t_start, t_end);
+	  activemsg_handler_table.record_message_profile(current_msg->handler,
+							 (current_msg->hdr_size +
+							  current_msg->payload_size),
+							 t_start - current_msg->t_enqueue,
+							 t_start, t_end);
+	}
 #ifdef DETAILED_MESSAGE_TIMING
 	detailed_message_timing.record(timing_idx, 
 				       current_msg->get_peer(),
@@ -885,7 +1295,7 @@ namespace Realm {
         num_handled += 1;
       }
       // we always handle all the messages, but still indicate we're done
-      return_messages(sender, num_handled, 0, 0);
+      return_messages(queue, num_handled, 0, 0);
     }
   }
 
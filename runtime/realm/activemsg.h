@@ -31,13 +31,20 @@
 namespace Realm {
 
   namespace Config {
-    // if true, the number and min/max/avg/stddev duration of handler per
-    //  message type is recorded and printed
+    // if true, the number, total size, queueing delay and min/max/avg/stddev
+    //  duration of handler per message type is recorded, published via
+    //  sampling profiler gauges, and printed at shutdown
     extern bool profile_activemsg_handlers;
 
     // the maximum time we're willing to spend on inline message
     //  handlers
     extern long long max_inline_message_time;
+
+    // number of independently-handled queues per sender - with more than
+    //  one, messages for handlers with inline variants get their own lane
+    //  and the rest are spread over the others by message ID, so ordering
+    //  is only guaranteed per (sender, handler) pair
+    extern int activemsg_handler_lanes;
   };
 
   enum { PAYLOAD_NONE, // no payload in packet
@@ -224,11 +231,19 @@ namespace Realm {
 
   struct ActiveMessageHandlerStats {
     atomic<size_t> count, sum, sum2, minval, maxval;
+    // message sizes and time spent waiting in the incoming message queue -
+    //  only recorded when handler profiling is enabled
+    atomic<size_t> bytes, queued_sum, queued_max;
 
     ActiveMessageHandlerStats(void);
     void record(long long t_start, long long t_end);
+    void record_message(size_t msg_bytes, long long queue_delay);
   };
 
+  // sampling profiler gauges for a single message handler - created the
+  //  first time a message for the handler is seen (with profiling enabled)
+  struct ActiveMessageHandlerGauges;
+
   // singleton class that can convert message type->ID and ID->handler
   class ActiveMessageHandlerTable {
   public:
@@ -266,10 +281,17 @@ namespace Realm {
       MessageHandlerNoTimeout handler_notimeout;
       MessageHandlerInline handler_inline;
       ActiveMessageHandlerStats stats;
+      atomic<ActiveMessageHandlerGauges *> gauges;
     };
 
     HandlerEntry *lookup_message_handler(MessageID id);
 
+    // records size, queueing delay (zero for messages handled inline) and
+    //  handler time of a message in the handler's stats and gauges
+    void record_message_profile(HandlerEntry *entry, size_t msg_bytes,
+				long long queue_delay,
+				long long t_start, long long t_end);
+
   protected:
     static ActiveMessageHandlerRegBase *pending_handlers;
 
@@ -326,6 +348,47 @@ namespace Realm {
     void force_instantiation(void) {}
   };
 
+  // collects many small active messages bound for a single target and
+  //  sends them as one network message - the target handles the whole
+  //  batch as a single incoming message, running each message's (non-inline)
+  //  handler in the order they were appended
+  // messages in a batch are always copied and cannot have completion
+  //  callbacks
+  class REALM_INTERNAL_API_EXTERNAL_LINKAGE ActiveMessageBatch {
+  public:
+    // a '_max_batch_size' of 0 picks a size based on what the network
+    //  can send without fragmentation
+    ActiveMessageBatch(NodeID _target, size_t _max_batch_size = 0);
+
+    // any messages that haven't been committed are sent
+    ~ActiveMessageBatch(void);
+
+    // appends a message for which a handler has been registered with
+    //  ActiveMessageHandlerReg<T> - if the batch is full, the messages
+    //  already in it are sent first
+    template <typename T>
+    void append(const T& header, const void *payload = 0,
+		size_t payload_size = 0);
+
+    size_t pending_messages(void) const;
+
+    // sends all pending messages - the batch may continue to be used
+    void commit(void);
+    // discards all pending messages
+    void cancel(void);
+
+  protected:
+    void append_message(ActiveMessageHandlerTable::MessageID msgid,
+			const void *header, size_t header_size,
+			const void *payload, size_t payload_size);
+
+    NodeID target;
+    size_t max_batch_size;
+    char *buffer;
+    size_t buffer_size, buffer_used;
+    unsigned num_messages;
+  };
+
   namespace ThreadLocal {
     // this flag will be true when we are running a message handler
     extern REALM_THREAD_LOCAL bool in_message_handler;
@@ -355,6 +418,15 @@ namespace Realm {
 			      CallbackData callback_data2,
 			      TimeLimit work_until);
 
+    // queues a message this node sent to itself without going through the
+    //  network (e.g. a local ActiveMessageBatch) - the header and payload
+    //  are copied, and the message is never handled inline
+    // such messages are not part of the network's received message count,
+    //  so they are left out of the count used by drain_incoming_messages
+    void add_local_message(ActiveMessageHandlerTable::MessageID msgid,
+			   const void *hdr, size_t hdr_size,
+			   const void *payload, size_t payload_size);
+
     void start_handler_threads(size_t stack_size);
 
     // stalls caller until all incoming messages have been handled (and at
@@ -383,6 +455,7 @@ namespace Realm {
       bool payload_needs_free;
       CallbackFnptr callback_fnptr;
       CallbackData callback_data1, callback_data2;
+      long long t_enqueue;  // only set if handler profiling is enabled
     };
 
     struct MessageBlock {
@@ -403,22 +476,50 @@ namespace Realm {
       MessageBlock *next_free;
     };
 
+    // a FIFO of queues with messages waiting - a queue is never in the list
+    //  more than once, so a ring buffer with a spare entry can't overflow
+    struct TodoList {
+      void init(int _max_entries);
+      void destroy();
+      bool empty() const;
+      void push(int queue);
+      int pop();
+
+      int *entries;
+      int max_entries, oldest, newest;
+    };
+
+    // each sender has 'num_lanes' message queues - these return the queue
+    //  a message is added to and the todo list that queue is placed on
+    int queue_index(NodeID sender, ActiveMessageHandlerTable::MessageID msgid,
+		    const ActiveMessageHandlerTable::HandlerEntry *handler) const;
+    TodoList& todo_list_for_queue(int queue);
+    bool todo_empty() const;
+    // called with mutex held
+    bool drain_count_reached() const;
+
+    // these return/accept a queue index rather than a sender
     int get_messages(Message *& head, Message **& tail, bool wait);
-    bool return_messages(int sender, size_t num_handled,
+    bool return_messages(int queue, size_t num_handled,
                          Message *head, Message **tail);
 
     int nodes, dedicated_threads, sleeper_count;
+    int num_lanes, num_queues;
     atomic<bool> bgwork_requested;
     int shutdown_flag;
     Message **heads;
     Message ***tails;
     bool *in_handler;
-    int *todo_list; // list of nodes with non-empty message lists
-    int todo_oldest, todo_newest;
+    // queues with non-empty message lists - queues in the cheap lane (if
+    //  there is one) are preferred, but only for a bounded number of
+    //  pops in a row so that the other lanes can't be starved
+    TodoList todo_list, cheap_todo_list;
+    int cheap_run_length;
     int handlers_active;
     bool drain_pending;
     size_t drain_min_count;
     size_t total_messages_handled;
+    size_t local_messages_added;
     Mutex mutex;
     Mutex::CondVar condvar, drain_condvar;
     CoreReservation *core_rsrv;
@@ -466,6 +466,20 @@ namespace Realm {
   }
 
 
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class ActiveMessageBatch
+  //
+
+  template <typename T>
+  void ActiveMessageBatch::append(const T& header, const void *payload,
+				  size_t payload_size)
+  {
+    append_message(activemsg_handler_table.lookup_message_id<T>(),
+		   &header, sizeof(T), payload, payload_size);
+  }
+
+
   ////////////////////////////////////////////////////////////////////////
   //
   // class CompletionCallback<CALLABLE>
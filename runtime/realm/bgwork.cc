@@ -472,6 +472,7 @@ namespace Realm {
     for(unsigned i = 0; i < BITMASK_ARRAY_SIZE; i++) {
       known_work_item_mask[i] = 0;
       allowed_work_item_mask[i] = 0;
+      preferred_work_item_mask[i] = 0;
     }
   }
 
@@ -485,6 +486,7 @@ namespace Realm {
     for(unsigned i = 0; i < BITMASK_ARRAY_SIZE; i++) {
       known_work_item_mask[i] = 0;
       allowed_work_item_mask[i] = 0;
+      preferred_work_item_mask[i] = 0;
     }
   }
 
@@ -495,6 +497,7 @@ namespace Realm {
     for(unsigned i = 0; i < BITMASK_ARRAY_SIZE; i++) {
       known_work_item_mask[i] = 0;
       allowed_work_item_mask[i] = 0;
+      preferred_work_item_mask[i] = 0;
     }
   }
 
@@ -505,6 +508,7 @@ namespace Realm {
     for(unsigned i = 0; i < BITMASK_ARRAY_SIZE; i++) {
       known_work_item_mask[i] = 0;
       allowed_work_item_mask[i] = 0;
+      preferred_work_item_mask[i] = 0;
     }
   }
   
@@ -561,16 +565,15 @@ namespace Realm {
             allowed = false;
 	  }
 
-	  // don't take things that are in the wrong numa domain
-	  if((numa_domain >= 0) && (item->numa_domain >= 0) &&
-	     (numa_domain != item->numa_domain)) {
-            allowed = false;
-	  }
-
+	  // work in another numa domain is still allowed (so that idle
+	  //  workers can steal it), but work in our own domain is preferred
           log_bgwork.info() << "worker " << this << " discovered slot " << unknown_slot << " (" << item->name << ") allowed=" << allowed;
 
-          if(allowed)
+          if(allowed) {
             allowed_work_item_mask[elem] |= unknown_bit;
+            if((numa_domain >= 0) && (item->numa_domain == numa_domain))
+              preferred_work_item_mask[elem] |= unknown_bit;
+          }
         }
         // unconditional decrement to match the increment
         manager->work_item_usecounts[unknown_slot].fetch_sub(1);
@@ -583,87 +586,27 @@ namespace Realm {
       //  just things we're allowed to take
       BitMask allowed_mask = (active_mask & allowed_work_item_mask[elem]);
 
-      while(allowed_mask != 0) {
-	// this leaves only the least significant 1 bit set
-	BitMask target_bit = allowed_mask & ~(allowed_mask - 1);
-	// attempt to clear this bit
-	BitMask prev = manager->active_work_item_mask[elem].fetch_and_acqrel(~target_bit);
-	if(prev & target_bit) {
-	  // success!
-
-          // decrement count of active work items - temporary underflow is
-          //  possible here, so no way to sanity-check state
-          manager->worker_state.fetch_sub(1 << BackgroundWorkManager::STATE_ACTIVE_ITEMS_SHIFT);
-
-	  unsigned slot = ((elem * BITMASK_BITS) + ctz(target_bit));
-	  log_bgwork.debug() << "work claimed: manager=" << manager
-			    << " slot=" << slot
-			    << " worker=" << this;
-	  long long t_start = Clock::current_time_in_nanoseconds(true /*absolute*/);
-	  // don't spend more than 1ms on any single task before going on to the
-	  //  next thing - TODO: pull this out as a config variable
-	  long long t_quantum = (manager->cfg.work_item_timeslice + t_start);
-	  if((work_until_time > 0) && (work_until_time < t_quantum))
-	    t_quantum = work_until_time;
-
-          // increase the use count for this slot - this should NEVER see
-          //  an invalid slot because we have claimed a work request and
-          //  not ack'd it yet
-          int prev_usecount = manager->work_item_usecounts[slot].fetch_add_acqrel(1);
-          assert(prev_usecount > 0);
-          (void)prev_usecount;
-
-	  BackgroundWorkItem *item = manager->work_items[slot];
-#ifdef DEBUG_REALM
-	  item->make_inactive();
-#endif
-          while(true) {
-            bool requeue = item->do_work(TimeLimit::absolute(t_quantum, interrupt_flag));
-            if(requeue) {
-              // we can just call this item's work function again if we're not out
-              //  of time and if there's nothing else to do
-              uint32_t other_work_items = (manager->worker_state.load() >> BackgroundWorkManager::STATE_ACTIVE_ITEMS_SHIFT);
-              if(other_work_items == 0) {
-                long long now = Clock::current_time_in_nanoseconds(true /*absolute*/);
-                if((work_until_time <= 0) || (work_until_time > now)) {
-                  // update t_quantum and then loop back around
-                  t_quantum = (manager->cfg.work_item_timeslice + now);
-                  if((work_until_time > 0) && (work_until_time < t_quantum))
-                    t_quantum = work_until_time;
-                  continue;
-                }
-              }
-              // if we fall through to here, we've got other stuff to do, so
-              //  actually enqueue the item before going on
-              item->make_active();
-              break;
-            } else
-              break;
-          }
-#ifdef REALM_BGWORK_PROFILE
-	  long long t_stop = Clock::current_time_in_nanoseconds(true /*absolute*/);
-	  long long elapsed = t_stop - t_start;
-	  long long overshoot = ((t_stop > t_quantum) ?
-	                           (t_stop - t_quantum) :
-	                           0);
-	  log_bgwork.print() << "work: slot=" << slot << " elapsed=" << elapsed << " overshoot=" << overshoot;
-#endif
-          // we're done with this slot for now
-          manager->work_item_usecounts[slot].fetch_sub_acqrel(1);
-
+      // numa-specific workers look at work in their own domain first - if
+      //  there is none, the round-robin scan below can take anything
+      //  allowed, including other domains' work, and the preferred pass
+      //  doesn't change where that scan picks up next
+      int slot = -1;
+      if(numa_domain >= 0)
+	slot = claim_preferred_work(work_until_time, interrupt_flag);
+      if(slot >= 0) {
+	did_work = true;
+      } else {
+	slot = claim_work(elem, allowed_mask,
+			  work_until_time, interrupt_flag);
+	if(slot >= 0) {
 	  starting_slot = slot + 1;
 	  did_work = true;
-	  break;
 	} else {
-	  // loop around and try other bits
-	  allowed_mask &= ~target_bit;
+	  // nothing could be claimed, so skip ahead to next chunk of bits
+	  starting_slot = (elem + 1) * BITMASK_BITS;
 	}
       }
 
-      // if we get here with a zero mask, skip ahead to next chunk of bits
-      if(allowed_mask == 0)
-        starting_slot = (elem + 1) * BITMASK_BITS;
-
       // before we loop around, see if there's been an interupt requested or
       //  we've used all the time permitted
       if(interrupt_flag != 0) {
@@ -678,5 +621,107 @@ namespace Realm {
     }
   }
 
+  int BackgroundWorkManager::Worker::claim_preferred_work(long long work_until_time,
+							  atomic<bool> *interrupt_flag)
+  {
+    unsigned num_elems = ((manager->num_work_items.load_acquire() +
+			   BITMASK_BITS - 1) / BITMASK_BITS);
+    for(unsigned elem = 0; elem < num_elems; elem++) {
+      if(preferred_work_item_mask[elem] == 0)
+	continue;
+      BitMask preferred = (manager->active_work_item_mask[elem].load() &
+			   preferred_work_item_mask[elem]);
+      if(preferred != 0) {
+	int slot = claim_work(elem, preferred, work_until_time, interrupt_flag);
+	if(slot >= 0)
+	  return slot;
+      }
+    }
+    return -1;
+  }
+
+  int BackgroundWorkManager::Worker::claim_work(unsigned elem,
+						BitMask candidates,
+						long long work_until_time,
+						atomic<bool> *interrupt_flag)
+  {
+    while(candidates != 0) {
+      // this leaves only the least significant 1 bit set
+      BitMask target_bit = candidates & ~(candidates - 1);
+      // attempt to clear this bit
+      BitMask prev = manager->active_work_item_mask[elem].fetch_and_acqrel(~target_bit);
+      if(prev & target_bit) {
+	// success!
+
+	// decrement count of active work items - temporary underflow is
+	//  possible here, so no way to sanity-check state
+	manager->worker_state.fetch_sub(1 << BackgroundWorkManager::STATE_ACTIVE_ITEMS_SHIFT);
+
+	unsigned slot = ((elem * BITMASK_BITS) + ctz(target_bit));
+	log_bgwork.debug() << "work claimed: manager=" << manager
+			  << " slot=" << slot
+			  << " worker=" << this;
+	long long t_start = Clock::current_time_in_nanoseconds(true /*absolute*/);
+	// don't spend more than 1ms on any single task before going on to the
+	//  next thing - TODO: pull this out as a config variable
+	long long t_quantum = (manager->cfg.work_item_timeslice + t_start);
+	if((work_until_time > 0) && (work_until_time < t_quantum))
+	  t_quantum = work_until_time;
+
+	// increase the use count for this slot - this should NEVER see
+	//  an invalid slot because we have claimed a work request and
+	//  not ack'd it yet
+	int prev_usecount = manager->work_item_usecounts[slot].fetch_add_acqrel(1);
+	assert(prev_usecount > 0);
+	(void)prev_usecount;
+
+	BackgroundWorkItem *item = manager->work_items[slot];
+#ifdef DEBUG_REALM
+	item->make_inactive();
+#endif
+	while(true) {
+	  bool requeue = item->do_work(TimeLimit::absolute(t_quantum, interrupt_flag));
+	  if(requeue) {
+	    // we can just call this item's work function again if we're not out
+	    //  of time and if there's nothing else to do
+	    uint32_t other_work_items = (manager->worker_state.load() >> BackgroundWorkManager::STATE_ACTIVE_ITEMS_SHIFT);
+	    if(other_work_items == 0) {
+	      long long now = Clock::current_time_in_nanoseconds(true /*absolute*/);
+	      if((work_until_time <= 0) || (work_until_time > now)) {
+		// update t_quantum and then loop back around
+		t_quantum = (manager->cfg.work_item_timeslice + now);
+		if((work_until_time > 0) && (work_until_time < t_quantum))
+		  t_quantum = work_until_time;
+		continue;
+	      }
+	    }
+	    // if we fall through to here, we've got other stuff to do, so
+	    //  actually enqueue the item before going on
+	    item->make_active();
+	    break;
+	  } else
+	    break;
+	}
+#ifdef REALM_BGWORK_PROFILE
+	long long t_stop = Clock::current_time_in_nanoseconds(true /*absolute*/);
+	long long elapsed = t_stop - t_start;
+	long long overshoot = ((t_stop > t_quantum) ?
+				 (t_stop - t_quantum) :
+				 0);
+	log_bgwork.print() << "work: slot=" << slot << " elapsed=" << elapsed << " overshoot=" << overshoot;
+#endif
+	// we're done with this slot for now
+	manager->work_item_usecounts[slot].fetch_sub_acqrel(1);
+
+	return slot;
+      } else {
+	// loop around and try other bits
+	candidates &= ~target_bit;
+      }
+    }
+
+    return -1;
+  }
+
 
 };
@@ -72,10 +72,22 @@ namespace Realm {
 		   atomic<bool> *interrupt_flag);
 
     protected:
+      // attempts to claim and perform one of the 'candidates' in 'elem' -
+      //  returns the slot index if successful or -1 if nothing was claimed
+      int claim_work(unsigned elem, BitMask candidates,
+		     long long work_until_time, atomic<bool> *interrupt_flag);
+
+      // for workers tied to a numa domain, tries the active work items in
+      //  that same domain before anything else
+      int claim_preferred_work(long long work_until_time,
+			       atomic<bool> *interrupt_flag);
+
       BackgroundWorkManager *manager;
       unsigned starting_slot;
       BitMask known_work_item_mask[BITMASK_ARRAY_SIZE];
       BitMask allowed_work_item_mask[BITMASK_ARRAY_SIZE];
+      // allowed items in the worker's own numa domain (if it has one)
+      BitMask preferred_work_item_mask[BITMASK_ARRAY_SIZE];
       long long max_timeslice;
       int numa_domain;
     };
@@ -132,6 +132,19 @@
   #define REALM_EXPECT(expr, expval) __builtin_expect((expr), (expval))
 #endif
 
+// REALM_VECTORIZE_LOOP - placed immediately before a `for` loop whose
+//                        iterations are independent, asks the compiler to
+//                        vectorize it
+#if defined(REALM_COMPILER_IS_CLANG)
+  #define REALM_VECTORIZE_LOOP _Pragma("clang loop vectorize(enable) interleave(enable)")
+#elif defined(REALM_COMPILER_IS_ICC)
+  #define REALM_VECTORIZE_LOOP _Pragma("ivdep")
+#elif defined(REALM_COMPILER_IS_GCC)
+  #define REALM_VECTORIZE_LOOP _Pragma("GCC ivdep")
+#else
+  #define REALM_VECTORIZE_LOOP
+#endif
+
 // REALM_ATTR_UNUSED(thing) - indicate that `thing` is unused
 #define REALM_ATTR_UNUSED(thing)  thing __attribute__((unused))
 
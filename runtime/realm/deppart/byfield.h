@@ -41,6 +41,11 @@ namespace Realm {
 
     void dispatch(PartitioningOperation *op, bool inline_ok);
 
+    // scans just the part of the instance within 'slab'
+    template <typename BM>
+    void populate_bitmasks_slab(std::map<FT, BM *>& bitmasks,
+				const Rect<N,T>& slab);
+
   protected:
     friend struct RemoteMicroOpMessage<ByFieldMicroOp<N,T,FT> >;
     static ActiveMessageHandlerReg<RemoteMicroOpMessage<ByFieldMicroOp<N,T,FT> > > areg;
@@ -53,9 +58,6 @@ namespace Realm {
     template <typename S>
     ByFieldMicroOp(NodeID _requestor, AsyncMicroOp *_async_microop, S& s);
 
-    template <typename BM>
-    void populate_bitmasks(std::map<FT, BM *>& bitmasks);
-
     IndexSpace<N,T> parent_space, inst_space;
     RegionInstance inst;
     size_t field_offset;
@@ -28,6 +28,8 @@ namespace Realm {
     extern bool cfg_disable_intersection_optimization;
     extern int cfg_max_rects_in_approximation;
     extern bool cfg_worker_threads_sleep;
+    extern size_t cfg_scan_chunk_points;
+    extern int cfg_max_scan_chunks;
 
   };
 
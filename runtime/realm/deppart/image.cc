@@ -138,13 +138,25 @@ namespace Realm {
 
   template <int N, typename T, int N2, typename T2>
   template <typename BM>
-  void ImageMicroOp<N,T,N2,T2>::populate_bitmasks_ptrs(std::map<int, BM *>& bitmasks)
+  void ImageMicroOp<N,T,N2,T2>::populate_bitmasks_slab(std::map<int, BM *>& bitmasks,
+						       const Rect<N2,T2>& slab)
+  {
+    if(is_ranged)
+      populate_bitmasks_ranges(bitmasks, slab);
+    else
+      populate_bitmasks_ptrs(bitmasks, slab);
+  }
+
+  template <int N, typename T, int N2, typename T2>
+  template <typename BM>
+  void ImageMicroOp<N,T,N2,T2>::populate_bitmasks_ptrs(std::map<int, BM *>& bitmasks,
+						       const Rect<N2,T2>& slab)
   {
     // for now, one access for the whole instance
     AffineAccessor<Point<N,T>,N2,T2> a_data(inst, field_offset);
 
     // double iteration - use the instance's space first, since it's probably smaller
-    for(IndexSpaceIterator<N2,T2> it(inst_space); it.valid; it.step()) {
+    for(IndexSpaceIterator<N2,T2> it(inst_space, slab); it.valid; it.step()) {
       for(size_t i = 0; i < sources.size(); i++) {
 	for(IndexSpaceIterator<N2,T2> it2(sources[i], it.rect); it2.valid; it2.step()) {
 	  BM **bmpp = 0;
@@ -173,13 +185,14 @@ namespace Realm {
 
   template <int N, typename T, int N2, typename T2>
   template <typename BM>
-  void ImageMicroOp<N,T,N2,T2>::populate_bitmasks_ranges(std::map<int, BM *>& bitmasks)
+  void ImageMicroOp<N,T,N2,T2>::populate_bitmasks_ranges(std::map<int, BM *>& bitmasks,
+							 const Rect<N2,T2>& slab)
   {
     // for now, one access for the whole instance
     AffineAccessor<Rect<N,T>,N2,T2> a_data(inst, field_offset);
 
     // double iteration - use the instance's space first, since it's probably smaller
-    for(IndexSpaceIterator<N2,T2> it(inst_space); it.valid; it.step()) {
+    for(IndexSpaceIterator<N2,T2> it(inst_space, slab); it.valid; it.step()) {
       for(size_t i = 0; i < sources.size(); i++) {
 	for(IndexSpaceIterator<N2,T2> it2(sources[i], it.rect); it2.valid; it2.step()) {
 	  BM **bmpp = 0;
@@ -272,10 +285,8 @@ namespace Realm {
       //std::map<int, DenseRectangleList<N,T> *> rect_map;
       std::map<int, HybridRectangleList<N,T> *> rect_map;
 
-      if(is_ranged)
-	populate_bitmasks_ranges(rect_map);
-      else
-	populate_bitmasks_ptrs(rect_map);
+      // large scans are split into slabs that idle workers can help with
+      populate_bitmasks_in_slabs(this, inst_space.bounds, rect_map);
 
 #ifdef DEBUG_PARTITIONING
       std::cout << rect_map.size() << " non-empty images present in instance " << inst << std::endl;
@@ -46,6 +46,11 @@ namespace Realm {
 
     void dispatch(PartitioningOperation *op, bool inline_ok);
 
+    // scans just the part of the instance within 'slab'
+    template <typename BM>
+    void populate_bitmasks_slab(std::map<int, BM *>& bitmasks,
+				const Rect<N2,T2>& slab);
+
   protected:
     friend struct RemoteMicroOpMessage<ImageMicroOp<N,T,N2,T2> >;
     static ActiveMessageHandlerReg<RemoteMicroOpMessage<ImageMicroOp<N,T,N2,T2> > > areg;
@@ -59,10 +64,12 @@ namespace Realm {
     ImageMicroOp(NodeID _requestor, AsyncMicroOp *_async_microop, S& s);
 
     template <typename BM>
-    void populate_bitmasks_ptrs(std::map<int, BM *>& bitmasks);
+    void populate_bitmasks_ptrs(std::map<int, BM *>& bitmasks,
+				const Rect<N2,T2>& slab);
 
     template <typename BM>
-    void populate_bitmasks_ranges(std::map<int, BM *>& bitmasks);
+    void populate_bitmasks_ranges(std::map<int, BM *>& bitmasks,
+				const Rect<N2,T2>& slab);
 
     template <typename BM>
     void populate_approx_bitmask_ptrs(BM& bitmask);
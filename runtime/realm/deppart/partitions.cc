@@ -44,6 +44,8 @@ namespace Realm {
     int cfg_max_rects_in_approximation = 32;
     bool cfg_worker_threads_sleep = true;
     bool cfg_allow_inline_operations = false;
+    size_t cfg_scan_chunk_points = 1 << 20; // 0 = never split a scan
+    int cfg_max_scan_chunks = 64;
   };
 
   // TODO: C++11 has type_traits and std::make_unsigned
@@ -827,6 +829,39 @@ namespace Realm {
   }
 
 
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class PartitioningChunkJob
+
+  PartitioningChunkJob::PartitioningChunkJob(size_t _num_chunks)
+    : num_chunks(_num_chunks), next_chunk(0), active_helpers(0)
+  {}
+
+  PartitioningChunkJob::~PartitioningChunkJob(void)
+  {}
+
+  void PartitioningChunkJob::run(void)
+  {
+    // only worth asking for help if there's more than one chunk
+    if((num_chunks > 1) && (deppart_op_queue != 0) &&
+       deppart_op_queue->run_chunk_job(this))
+      return;
+
+    // somebody else's job is posted (or there's no queue) - do it all here
+    while(do_one_chunk()) {}
+  }
+
+  bool PartitioningChunkJob::do_one_chunk(void)
+  {
+    size_t idx = next_chunk.fetch_add(1);
+    if(idx >= num_chunks)
+      return false;
+
+    execute_chunk(idx);
+    return true;
+  }
+
+
   ////////////////////////////////////////////////////////////////////////
   //
   // class PartitioningOpQueue
@@ -835,7 +870,7 @@ namespace Realm {
 					    BackgroundWorkManager *_bgwork)
     : BackgroundWorkItem("deppart op queue")
     , shutdown_flag(false), rsrv(_rsrv), condvar(mutex)
-    , work_advertised(false)
+    , work_advertised(false), chunk_job(0), chunk_done(mutex)
   {
     if(_bgwork)
       add_to_manager(_bgwork);
@@ -855,6 +890,8 @@ namespace Realm {
     cp.add_option_bool("-dp:noisectopt", DeppartConfig::cfg_disable_intersection_optimization);
     cp.add_option_int("-dp:sleep", DeppartConfig::cfg_worker_threads_sleep);
     cp.add_option_int("-dp:inline_ok", DeppartConfig::cfg_allow_inline_operations);
+    cp.add_option_int("-dp:chunk", DeppartConfig::cfg_scan_chunk_points);
+    cp.add_option_int("-dp:maxchunks", DeppartConfig::cfg_max_scan_chunks);
 
     cp.parse_command_line(cmdline);
   }
@@ -939,18 +976,79 @@ namespace Realm {
       make_active();
   }
 
+  bool PartitioningOpQueue::run_chunk_job(PartitioningChunkJob *job)
+  {
+    bool need_advertise;
+    {
+      AutoLock<> al(mutex);
+
+      if(chunk_job != 0)
+	return false;
+      chunk_job = job;
+
+      need_advertise = !work_advertised;
+      work_advertised = true;
+
+      if(!workers.empty())
+	condvar.broadcast();
+    }
+
+    if(need_advertise)
+      make_active();
+
+    // work on chunks ourselves - if no helpers show up, we do them all
+    while(job->do_one_chunk()) {}
+
+    // unpost the job so no new helpers join, and then sleep until any
+    //  still working on their last chunk are done
+    {
+      AutoLock<> al(mutex);
+      chunk_job = 0;
+      while(job->active_helpers > 0)
+	chunk_done.wait();
+    }
+
+    return true;
+  }
+
+  bool PartitioningOpQueue::help_with_chunk_job(void)
+  {
+    PartitioningChunkJob *job;
+    {
+      AutoLock<> al(mutex);
+      job = chunk_job;
+      if(job == 0)
+	return false;
+      job->active_helpers++;
+    }
+
+    while(job->do_one_chunk()) {}
+
+    {
+      AutoLock<> al(mutex);
+      if(--job->active_helpers == 0)
+	chunk_done.broadcast();
+    }
+    return true;
+  }
+
   bool PartitioningOpQueue::do_work(TimeLimit work_until)
   {
     // attempt to take one item off the work queue - readvertise work if
     //  more remains
     PartitioningOperation *op = 0;
     PartitioningMicroOp *uop = 0;
+    bool help_chunks = false;
     bool readvertise;
     {
       AutoLock<> al(mutex);
 
-      // prefer micro ops over operations
-      if(!uop_list.empty())
+      // helping with a posted chunk job comes first - it holds up a micro op
+      //  that is already running - otherwise prefer micro ops over operations
+      if((chunk_job != 0) &&
+	 (chunk_job->next_chunk.load() < chunk_job->num_chunks))
+	help_chunks = true;
+      else if(!uop_list.empty())
 	uop = uop_list.pop_front();
       else if(!op_list.empty())
 	op = op_list.pop_front();
@@ -958,14 +1056,19 @@ namespace Realm {
 #ifdef DEBUG_REALM
       assert(work_advertised);
 #endif
-      work_advertised = !op_list.empty() || !uop_list.empty();
+      // a chunk job stays advertised so that each helper recruits another
+      //  until they run out of chunks
+      work_advertised = !op_list.empty() || !uop_list.empty() || help_chunks;
       readvertise = work_advertised;
     }
     if(readvertise) {
-      assert(((op != 0) || (uop != 0)) && (manager != 0));
+      assert(((op != 0) || (uop != 0) || help_chunks) && (manager != 0));
       make_active();
     }
 
+    if(help_chunks)
+      help_with_chunk_job();
+
     // now we can work on the op we got in parallel with everybody else
     //  (neither branch will be taken if there are dedicated workers and they
     //  already got to the queued operations)
@@ -1001,16 +1104,21 @@ namespace Realm {
     while(!shutdown_flag.load()) {
       PartitioningOperation *op = 0;
       PartitioningMicroOp *uop = 0;
-      while(!op && !uop && !shutdown_flag.load()) {
+      bool help_chunks = false;
+      while(!op && !uop && !help_chunks && !shutdown_flag.load()) {
 	AutoLock<> al(mutex);
 
-	// prefer micro ops over operations
-	if(!uop_list.empty())
+	// help with a posted chunk job first, then prefer micro ops over
+	//  operations
+	if((chunk_job != 0) &&
+	   (chunk_job->next_chunk.load() < chunk_job->num_chunks))
+	  help_chunks = true;
+	else if(!uop_list.empty())
 	  uop = uop_list.pop_front();
 	else if(!op_list.empty())
 	  op = op_list.pop_front();
 
-	if(!op && !uop && !shutdown_flag.load()) {
+	if(!op && !uop && !help_chunks && !shutdown_flag.load()) {
           if(DeppartConfig::cfg_worker_threads_sleep) {
 	    condvar.wait();
           } else {
@@ -1021,6 +1129,9 @@ namespace Realm {
         }
       }
 
+      if(help_chunks)
+	help_with_chunk_job();
+
       if(op) {
 	bool ok_to_run = op->mark_started();
 	if(ok_to_run) {
@@ -31,6 +31,7 @@
 #include "realm/dynamic_templates.h"
 #include "realm/deppart/sparsity_impl.h"
 #include "realm/deppart/inst_helper.h"
+#include "realm/deppart/deppart_config.h"
 #include "realm/bgwork.h"
 
 namespace Realm {
@@ -188,6 +189,40 @@ namespace Realm {
   ////////////////////////////////////////
   //
 
+  // a piece of a micro-op's work that has been broken into independent
+  //  chunks - the thread running the micro-op and any idle partitioning
+  //  workers claim chunks until they run out
+  class PartitioningChunkJob {
+  public:
+    PartitioningChunkJob(size_t _num_chunks);
+    virtual ~PartitioningChunkJob(void);
+
+    // runs every chunk, returning once they are all done
+    void run(void);
+
+    // returns false if there were no chunks left to claim
+    bool do_one_chunk(void);
+
+    size_t num_chunks;
+
+  protected:
+    virtual void execute_chunk(size_t idx) = 0;
+
+    friend class PartitioningOpQueue;
+    atomic<size_t> next_chunk;
+    int active_helpers;  // protected by the op queue's mutex
+  };
+
+  // splits the work of filling in a map of rectangle lists (one per output)
+  //  from a scan over 'bounds' into slabs along the outermost dimension -
+  //  each slab fills its own lists via 'uop->populate_bitmasks_slab(map, slab)'
+  //  and then the lists for each output are merged in slab order - if the
+  //  scan isn't big enough to be worth splitting, 'bounds' is scanned as one
+  //  slab directly into 'bitmasks'
+  template <typename UOP, int N, typename T, typename KEY, typename BM>
+  void populate_bitmasks_in_slabs(UOP *uop, const Rect<N,T>& bounds,
+				  std::map<KEY, BM *>& bitmasks);
+
   class PartitioningOpQueue : public BackgroundWorkItem {
   public:
     PartitioningOpQueue(CoreReservation *_rsrv,
@@ -207,7 +242,15 @@ namespace Realm {
     // called by BackgroundWorkers
     bool do_work(TimeLimit work_until);
 
+    // posts 'job' for idle workers to help with and works on it until all
+    //  of its chunks are done - only one job is posted at a time, so returns
+    //  false without doing anything if another job already is
+    bool run_chunk_job(PartitioningChunkJob *job);
+
   protected:
+    // claims chunks of the posted job, if any - returns true if there was one
+    bool help_with_chunk_job(void);
+
     atomic<bool> shutdown_flag;
     CoreReservation *rsrv;
     PartitioningOperation::OpList op_list;
@@ -216,6 +259,8 @@ namespace Realm {
     Mutex::CondVar condvar;
     std::vector<Thread *> workers;
     bool work_advertised;
+    PartitioningChunkJob *chunk_job;  // protected by mutex
+    Mutex::CondVar chunk_done;
   };
 
 
@@ -52,5 +52,130 @@ namespace Realm {
   }
 
 
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // populate_bitmasks_in_slabs
+  //
+
+  // scans one slab per chunk, each into its own map of lists
+  template <typename UOP, int N, typename T, typename KEY, typename BM>
+  class PopulateSlabsJob : public PartitioningChunkJob {
+  public:
+    PopulateSlabsJob(UOP *_uop, const std::vector<Rect<N,T> >& _slabs)
+      : PartitioningChunkJob(_slabs.size())
+      , uop(_uop), slabs(_slabs), slab_bitmasks(_slabs.size())
+    {}
+
+    UOP *uop;
+    const std::vector<Rect<N,T> >& slabs;
+    std::vector<std::map<KEY, BM *> > slab_bitmasks;
+
+  protected:
+    virtual void execute_chunk(size_t idx)
+    {
+      uop->populate_bitmasks_slab(slab_bitmasks[idx], slabs[idx]);
+    }
+  };
+
+  // the lists' rectangles needn't have the same dimension as the slabs
+  //  (e.g. for an image), so let the compiler work out the type
+  template <typename BM, typename RECT>
+  inline void add_rects_to_list(BM *bmp, const std::vector<RECT>& rects)
+  {
+    for(typename std::vector<RECT>::const_iterator it = rects.begin();
+	it != rects.end();
+	++it)
+      bmp->add_rect(*it);
+  }
+
+  // merges one output's lists from every slab per chunk - the first slab's
+  //  list is reused and the rest are added to it in slab order
+  template <typename KEY, typename BM>
+  class MergeSlabsJob : public PartitioningChunkJob {
+  public:
+    MergeSlabsJob(const std::vector<std::map<KEY, BM *> >& _slab_bitmasks,
+		  const std::vector<KEY>& _keys)
+      : PartitioningChunkJob(_keys.size())
+      , slab_bitmasks(_slab_bitmasks), keys(_keys), merged(_keys.size(), 0)
+    {}
+
+    const std::vector<std::map<KEY, BM *> >& slab_bitmasks;
+    const std::vector<KEY>& keys;
+    std::vector<BM *> merged;
+
+  protected:
+    virtual void execute_chunk(size_t idx)
+    {
+      BM *bmp = 0;
+      for(size_t i = 0; i < slab_bitmasks.size(); i++) {
+	typename std::map<KEY, BM *>::const_iterator it = slab_bitmasks[i].find(keys[idx]);
+	if(it == slab_bitmasks[i].end())
+	  continue;
+	if(!bmp) {
+	  bmp = it->second;
+	  continue;
+	}
+	add_rects_to_list(bmp, it->second->convert_to_vector());
+	delete it->second;
+      }
+      merged[idx] = bmp;
+    }
+  };
+
+  template <typename UOP, int N, typename T, typename KEY, typename BM>
+  void populate_bitmasks_in_slabs(UOP *uop, const Rect<N,T>& bounds,
+				  std::map<KEY, BM *>& bitmasks)
+  {
+    // aim for cfg_scan_chunk_points points per slab, and at least one row
+    //  of the outermost dimension in each
+    size_t num_slabs = 1;
+    size_t extent = 0;
+    if(!bounds.empty() && (DeppartConfig::cfg_scan_chunk_points > 0) &&
+       (DeppartConfig::cfg_max_scan_chunks > 1)) {
+      extent = size_t(bounds.hi[N-1]) - size_t(bounds.lo[N-1]) + 1;
+      num_slabs = std::min(bounds.volume() / DeppartConfig::cfg_scan_chunk_points,
+			   std::min(extent,
+				    size_t(DeppartConfig::cfg_max_scan_chunks)));
+    }
+
+    if(num_slabs <= 1) {
+      uop->populate_bitmasks_slab(bitmasks, bounds);
+      return;
+    }
+
+    // the last slab picks up any remainder
+    std::vector<Rect<N,T> > slabs(num_slabs, bounds);
+    size_t step = extent / num_slabs;
+    for(size_t i = 0; i < num_slabs; i++) {
+      slabs[i].lo[N-1] = T(size_t(bounds.lo[N-1]) + (i * step));
+      if(i < (num_slabs - 1))
+	slabs[i].hi[N-1] = T(size_t(bounds.lo[N-1]) + ((i + 1) * step) - 1);
+    }
+
+    PopulateSlabsJob<UOP,N,T,KEY,BM> scan(uop, slabs);
+    scan.run();
+
+    // every output found by any slab gets merged
+    assert(bitmasks.empty());
+    for(size_t i = 0; i < num_slabs; i++)
+      for(typename std::map<KEY, BM *>::const_iterator it = scan.slab_bitmasks[i].begin();
+	  it != scan.slab_bitmasks[i].end();
+	  ++it)
+	bitmasks[it->first] = 0;
+    std::vector<KEY> keys;
+    keys.reserve(bitmasks.size());
+    for(typename std::map<KEY, BM *>::const_iterator it = bitmasks.begin();
+	it != bitmasks.end();
+	++it)
+      keys.push_back(it->first);
+
+    MergeSlabsJob<KEY,BM> merge(scan.slab_bitmasks, keys);
+    merge.run();
+
+    for(size_t i = 0; i < keys.size(); i++)
+      bitmasks[keys[i]] = merge.merged[i];
+  }
+
+
 };
 
@@ -90,13 +90,25 @@ namespace Realm {
 
   template <int N, typename T, int N2, typename T2>
   template <typename BM>
-  void PreimageMicroOp<N,T,N2,T2>::populate_bitmasks_ptrs(std::map<int, BM *>& bitmasks)
+  void PreimageMicroOp<N,T,N2,T2>::populate_bitmasks_slab(std::map<int, BM *>& bitmasks,
+						          const Rect<N,T>& slab)
+  {
+    if(is_ranged)
+      populate_bitmasks_ranges(bitmasks, slab);
+    else
+      populate_bitmasks_ptrs(bitmasks, slab);
+  }
+
+  template <int N, typename T, int N2, typename T2>
+  template <typename BM>
+  void PreimageMicroOp<N,T,N2,T2>::populate_bitmasks_ptrs(std::map<int, BM *>& bitmasks,
+							  const Rect<N,T>& slab)
   {
     // for now, one access for the whole instance
     AffineAccessor<Point<N2,T2>,N,T> a_data(inst, field_offset);
 
     // double iteration - use the instance's space first, since it's probably smaller
-    for(IndexSpaceIterator<N,T> it(inst_space); it.valid; it.step()) {
+    for(IndexSpaceIterator<N,T> it(inst_space, slab); it.valid; it.step()) {
       for(IndexSpaceIterator<N,T> it2(parent_space, it.rect); it2.valid; it2.step()) {
 	// now iterate over each point
 	for(PointInRectIterator<N,T> pir(it2.rect); pir.valid; pir.step()) {
@@ -116,13 +128,14 @@ namespace Realm {
 
   template <int N, typename T, int N2, typename T2>
   template <typename BM>
-  void PreimageMicroOp<N,T,N2,T2>::populate_bitmasks_ranges(std::map<int, BM *>& bitmasks)
+  void PreimageMicroOp<N,T,N2,T2>::populate_bitmasks_ranges(std::map<int, BM *>& bitmasks,
+							    const Rect<N,T>& slab)
   {
     // for now, one access for the whole instance
     AffineAccessor<Rect<N2,T2>,N,T> a_data(inst, field_offset);
 
     // double iteration - use the instance's space first, since it's probably smaller
-    for(IndexSpaceIterator<N,T> it(inst_space); it.valid; it.step()) {
+    for(IndexSpaceIterator<N,T> it(inst_space, slab); it.valid; it.step()) {
       for(IndexSpaceIterator<N,T> it2(parent_space, it.rect); it2.valid; it2.step()) {
 	// now iterate over each point
 	for(PointInRectIterator<N,T> pir(it2.rect); pir.valid; pir.step()) {
@@ -146,10 +159,10 @@ namespace Realm {
     TimeStamp ts("PreimageMicroOp::execute", true, &log_uop_timing);
     std::map<int, DenseRectangleList<N,T> *> rect_map;
 
-    if(is_ranged)
-      populate_bitmasks_ranges(rect_map);
-    else
-      populate_bitmasks_ptrs(rect_map);
+    // large scans are split into slabs that idle workers can help with
+    populate_bitmasks_in_slabs(this,
+			       inst_space.bounds.intersection(parent_space.bounds),
+			       rect_map);
 
 #ifdef DEBUG_PARTITIONING
     std::cout << rect_map.size() << " non-empty preimages present in instance " << inst << std::endl;
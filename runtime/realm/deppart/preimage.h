@@ -40,6 +40,11 @@ namespace Realm {
 
     void dispatch(PartitioningOperation *op, bool inline_ok);
 
+    // scans just the part of the instance within 'slab'
+    template <typename BM>
+    void populate_bitmasks_slab(std::map<int, BM *>& bitmasks,
+				const Rect<N,T>& slab);
+
   protected:
     friend struct RemoteMicroOpMessage<PreimageMicroOp<N,T,N2,T2> >;
     static ActiveMessageHandlerReg<RemoteMicroOpMessage<PreimageMicroOp<N,T,N2,T2> > > areg;
@@ -53,10 +58,12 @@ namespace Realm {
     PreimageMicroOp(NodeID _requestor, AsyncMicroOp *_async_microop, S& s);
 
     template <typename BM>
-    void populate_bitmasks_ptrs(std::map<int, BM *>& bitmasks);
+    void populate_bitmasks_ptrs(std::map<int, BM *>& bitmasks,
+				const Rect<N,T>& slab);
 
     template <typename BM>
-    void populate_bitmasks_ranges(std::map<int, BM *>& bitmasks);
+    void populate_bitmasks_ranges(std::map<int, BM *>& bitmasks,
+				const Rect<N,T>& slab);
 
     IndexSpace<N,T> parent_space, inst_space;
     RegionInstance inst;
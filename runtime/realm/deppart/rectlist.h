@@ -56,6 +56,9 @@ namespace Realm {
 
     void merge_rects(size_t upper_bound);
 
+    // for symmetry with HybridRectangleList
+    const std::vector<Rect<N,T> >& convert_to_vector(void);
+
     std::vector<Rect<N,T> > rects;
     size_t max_rects;
     int merge_dim;
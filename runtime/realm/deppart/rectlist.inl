@@ -81,6 +81,12 @@ namespace Realm {
     }
   }
 
+  template <int N, typename T>
+  inline const std::vector<Rect<N,T> >& DenseRectangleList<N,T>::convert_to_vector(void)
+  {
+    return rects;
+  }
+
   template <int N, typename T>
   inline void DenseRectangleList<N,T>::add_point(const Point<N,T>& p)
   {
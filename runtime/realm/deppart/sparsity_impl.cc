@@ -165,9 +165,60 @@ namespace Realm {
 
   template <int N, typename T>
   SparsityMapPublicImpl<N,T>::SparsityMapPublicImpl(void)
-    : entries_valid(false), approx_valid(false)
+    : entries_valid(false), approx_valid(false), entry_index(0)
   {}
 
+  template <int N, typename T>
+  SparsityMapPublicImpl<N,T>::~SparsityMapPublicImpl(void)
+  {
+    delete entry_index.load();
+  }
+
+  // built on first use and never changed after that - if two threads race to
+  //  build it, the loser throws its copy away
+  template <int N, typename T>
+  const typename SparsityMapPublicImpl<N,T>::EntryIndex *SparsityMapPublicImpl<N,T>::get_entry_index(void)
+  {
+    EntryIndex *index = entry_index.load_acquire();
+    if(index)
+      return index;
+
+    index = new EntryIndex;
+    const std::vector<SparsityMapEntry<N,T> >& e = get_entries();
+    {
+      index->levels.resize(1);
+      std::vector<Rect<N,T> >& boxes = index->levels[0];
+      boxes.reserve((e.size() + ENTRY_INDEX_FANOUT - 1) / ENTRY_INDEX_FANOUT);
+      for(size_t i = 0; i < e.size(); i += ENTRY_INDEX_FANOUT) {
+	Rect<N,T> bbox = e[i].bounds;
+	size_t i_hi = std::min(i + ENTRY_INDEX_FANOUT, e.size());
+	for(size_t j = i + 1; j < i_hi; j++)
+	  bbox = bbox.union_bbox(e[j].bounds);
+	boxes.push_back(bbox);
+      }
+    }
+    while(index->levels.back().size() > 1) {
+      // 'children' stays valid until the new level is appended below
+      const std::vector<Rect<N,T> >& children = index->levels.back();
+      std::vector<Rect<N,T> > boxes;
+      boxes.reserve((children.size() + ENTRY_INDEX_FANOUT - 1) / ENTRY_INDEX_FANOUT);
+      for(size_t i = 0; i < children.size(); i += ENTRY_INDEX_FANOUT) {
+	Rect<N,T> bbox = children[i];
+	size_t i_hi = std::min(i + ENTRY_INDEX_FANOUT, children.size());
+	for(size_t j = i + 1; j < i_hi; j++)
+	  bbox = bbox.union_bbox(children[j]);
+	boxes.push_back(bbox);
+      }
+      index->levels.push_back(boxes);
+    }
+
+    EntryIndex *expected = 0;
+    if(entry_index.compare_exchange(expected, index))
+      return index;
+    delete index;
+    return expected;
+  }
+
   // call actual implementation - inlining makes this cheaper than a virtual method
   template <int N, typename T>
   Event SparsityMapPublicImpl<N,T>::make_valid(bool precise /*= true*/)
@@ -182,8 +233,8 @@ namespace Realm {
 					    const Rect<N,T>& bounds,
 					    bool approx)
   {
-    // full cross-product test for now - for larger rectangle lists, consider
-    //  an acceleration structure?
+    // full cross-product test for the approximations, which are small - the
+    //  precise entries are looked up in the other map's entry index
     if(approx) {
       const std::vector<Rect<N,T> >& rects1 = get_approx_rects();
       const std::vector<Rect<N,T> >& rects2 = other->get_approx_rects();
@@ -209,13 +260,12 @@ namespace Realm {
 	Rect<N,T> isect = it1->bounds.intersection(bounds);
 	if(isect.empty())
 	  continue;
-	for(typename std::vector<SparsityMapEntry<N,T> >::const_iterator it2 = entries2.begin();
-	    it2 != entries2.end();
-	    it2++) {
-	  if(!it2->bounds.overlaps(isect)) continue;
+	size_t idx2 = other->find_overlapping_entry(isect);
+	if(idx2 < entries2.size()) {
 	  // TODO: handle further sparsity in either side
 	  assert(!it1->sparsity.exists() && (it1->bitmap == 0) &&
-		 !it2->sparsity.exists() && (it2->bitmap == 0));
+		 !entries2[idx2].sparsity.exists() &&
+		 (entries2[idx2].bitmap == 0));
 	  return true;
 	}
       }
@@ -693,6 +693,8 @@ namespace Realm {
     Event e = search_from;
     while(true) {
       EventWaiter *waiters_head = 0;
+      // waiters to consider at this step (lock-free stack and list waiters)
+      std::vector<EventWaiter *> candidates;
       Event next_barrier_gen = Event::NO_EVENT;
 
       ID id(e);
@@ -702,6 +704,14 @@ namespace Realm {
 	{
 	  AutoLock<> al(impl->mutex);
 	  gen_t gen = impl->generation.load();
+	  // the lock-free stack can't be taken while we hold the mutex, so
+	  //  walk it in place - this is a diagnostic and must not wake or
+	  //  move any waiters
+	  for(EventWaiter *ew = impl->lockfree_waiters.load_acquire();
+	      ew;
+	      ew = ew->ew_stack_next)
+	    if(ew->ew_stack_gen == id.event_generation())
+	      candidates.push_back(ew);
 	  if(gen >= id.event_generation()) {
 	    // already triggered!?
 	    assert(0);
@@ -741,8 +751,13 @@ namespace Realm {
 
       // record all of these event waiters as seen before traversing, so that we find the
       //  shortest possible path
+      for(EventWaiter *pos = waiters_head; pos; pos = pos->ew_list_link.next)
+	candidates.push_back(pos);
       int count = 0;
-      for(EventWaiter *pos = waiters_head; pos; pos = pos->ew_list_link.next) {
+      for(std::vector<EventWaiter *>::const_iterator it = candidates.begin();
+	  it != candidates.end();
+	  ++it) {
+	EventWaiter *pos = *it;
 	Event e2 = pos->get_finish_event();
 	if(!e2.exists()) continue;
 	if(e2 == target) {
@@ -991,6 +1006,7 @@ namespace Realm {
     , num_poisoned_generations(0)
     , merger(this)
     , current_trigger_op(nullptr)
+    , lockfree_waiters(0)
     , has_external_waiters(false)
     , external_waiter_condvar(external_waiter_mutex)
   {
@@ -998,6 +1014,7 @@ namespace Realm {
     poisoned_generations = 0;
     has_local_triggers = false;
     free_list_insertion_delayed = false;
+    pool = 0;
   }
 
   GenEventImpl::~GenEventImpl(void)
@@ -1006,10 +1023,12 @@ namespace Realm {
     AutoLock<> a(mutex);
     if(!current_local_waiters.empty() ||
        !future_local_waiters.empty() ||
+       (lockfree_waiters.load() != 0) ||
        has_external_waiters ||
        !remote_waiters.empty()) {
       log_event.fatal() << "Event " << me << " destroyed with"
 			<< (current_local_waiters.empty() ? "" : " current local waiters")
+			<< ((lockfree_waiters.load() == 0) ? "" : " lock-free local waiters")
 			<< (future_local_waiters.empty() ? "" : " current future waiters")
 			<< (has_external_waiters ? " external waiters" : "")
 			<< (remote_waiters.empty() ? "" : " remote waiters");
@@ -1017,6 +1036,8 @@ namespace Realm {
 	EventWaiter *ew = current_local_waiters.pop_front();
 	log_event.fatal() << "  waiting on " << make_event(generation.load() + 1) << ": " << ew;
       }
+      for(EventWaiter *ew = lockfree_waiters.load(); ew; ew = ew->ew_stack_next)
+	log_event.fatal() << "  waiting on " << make_event(ew->ew_stack_gen) << ": " << ew;
       for(std::map<gen_t, EventWaiter::EventWaiterList>::iterator it = future_local_waiters.begin();
 	  it != future_local_waiters.end();
 	  ++it) {
@@ -1299,6 +1320,33 @@ namespace Realm {
       // no early check here as the caller will generally have tried has_triggered()
       //  before allocating its EventWaiter object
 
+      // the owner never needs to subscribe or track future generations, so
+      //  the waiter can be pushed onto the lock-free stack without the mutex
+      if(owner == Network::my_node_id) {
+	gen_t cur_gen = generation.load_acquire();
+	if(needed_gen <= cur_gen) {
+	  waiter->event_triggered(is_generation_poisoned(needed_gen),
+				  TimeLimit::responsive());
+	  return true;
+	}
+
+	// no future waiters on the owner
+	assert(needed_gen == (cur_gen + 1));
+	waiter->ew_stack_gen = needed_gen;
+	EventWaiter *prev_head = lockfree_waiters.load();
+	do {
+	  waiter->ew_stack_next = prev_head;
+	} while(!lockfree_waiters.compare_exchange(prev_head, waiter));
+
+	// if a trigger updated the generation before our push landed, it may
+	//  have already swapped out the stack, so drain it ourselves - the
+	//  atomic exchange guarantees each waiter is claimed exactly once
+	if(generation.load_acquire() >= needed_gen)
+	  drain_lockfree_waiters(TimeLimit::responsive());
+
+	return true;  // waiter is always either enqueued or triggered right now
+      }
+
       bool trigger_now = false;
       bool trigger_poisoned = false;
 
@@ -1362,6 +1410,37 @@ namespace Realm {
 
     bool GenEventImpl::remove_waiter(gen_t needed_gen, EventWaiter *waiter)
     {
+      if(owner == Network::my_node_id) {
+	// on the owner, the waiter is probably on the lock-free stack - move
+	//  everything from there into the current waiter list before looking
+	// every waiter taken off the stack is sorted while holding the mutex,
+	//  so once we have it, an untriggered waiter can only be in the
+	//  current waiter list
+	EventWaiter::EventWaiterList to_wake, to_wake_poisoned;
+	bool triggered, found;
+	{
+	  AutoLock<> a(mutex);
+
+	  claim_lockfree_waiters(to_wake, to_wake_poisoned);
+
+	  triggered = (needed_gen <= generation.load());
+	  found = (!triggered &&
+		   (current_local_waiters.erase(waiter) > 0));
+	  assert(triggered || found);
+	}
+
+	if(!to_wake.empty())
+	  get_runtime()->event_triggerer.trigger_event_waiters(to_wake,
+							       false /*!poisoned*/,
+							       TimeLimit::responsive());
+	if(!to_wake_poisoned.empty())
+	  get_runtime()->event_triggerer.trigger_event_waiters(to_wake_poisoned,
+							       true /*poisoned*/,
+							       TimeLimit::responsive());
+
+	return found;
+      }
+
       AutoLock<> a(mutex);
 
       // case 1: the event has already triggered, so nothing to remove
@@ -1829,6 +1908,7 @@ namespace Realm {
 #endif
 
       EventWaiter::EventWaiterList to_wake;
+      EventWaiter::EventWaiterList lockfree_to_wake, lockfree_to_wake_poisoned;
 
       if(Network::my_node_id == owner) {
 	// we own this event
@@ -1836,6 +1916,7 @@ namespace Realm {
 	NodeSet to_update;
 	gen_t update_gen;
 	bool free_event = false;
+	bool return_to_pool = false;
 
 	{
 	  AutoLock<> a(mutex);
@@ -1877,6 +1958,12 @@ namespace Realm {
 	  // list is valid to any observer of this update
 	  generation.store_release(gen_triggered);
 
+	  // now that the new generation is visible, take everything that was
+	  //  pushed onto the lock-free stack - anybody who pushes after this
+	  //  will see the updated generation and drain the stack themselves
+	  // this has to happen before the event can go back on the free list
+	  claim_lockfree_waiters(lockfree_to_wake, lockfree_to_wake_poisoned);
+
 	  // we'll free the event unless it's maxed out on poisoned generations
 	  //  or generation count
 	  free_event = ((gen_triggered < ((1U << ID::EVENT_GENERATION_WIDTH) - 1)) &&
@@ -1887,6 +1974,12 @@ namespace Realm {
 	    free_list_insertion_delayed = true;
 	    free_event = false;
 	  }
+	  // pooled events go back to their pool instead, which deals with
+	  //  maxed-out events itself
+	  if(pool != 0) {
+	    return_to_pool = !free_list_insertion_delayed;
+	    free_event = false;
+	  }
 
 	  // external waiters need to be signalled inside the lock
 	  if(has_external_waiters) {
@@ -1910,6 +2003,8 @@ namespace Realm {
 	// free event?
 	if(free_event)
           GenEventImpl::free_genevent(this);
+	else if(return_to_pool)
+	  pool->event_idle(this);
       } else {
 	// we're triggering somebody else's event, so the first thing to do is tell them
 	assert(trigger_node == (int)Network::my_node_id);
@@ -2007,6 +2102,77 @@ namespace Realm {
 	get_runtime()->event_triggerer.trigger_event_waiters(to_wake,
 							     poisoned,
 							     work_until);
+      if(!lockfree_to_wake.empty())
+	get_runtime()->event_triggerer.trigger_event_waiters(lockfree_to_wake,
+							     false /*!poisoned*/,
+							     work_until);
+      if(!lockfree_to_wake_poisoned.empty())
+	get_runtime()->event_triggerer.trigger_event_waiters(lockfree_to_wake_poisoned,
+							     true /*poisoned*/,
+							     work_until);
+    }
+
+    void GenEventImpl::sort_lockfree_waiters(EventWaiter *head, gen_t cur_gen,
+					     EventWaiter::EventWaiterList& to_wake,
+					     EventWaiter::EventWaiterList& to_wake_poisoned,
+					     EventWaiter::EventWaiterList& not_ready)
+    {
+      // the stack is LIFO - reverse it so waiters are woken in the order
+      //  they were added
+      EventWaiter *fifo = 0;
+      while(head != 0) {
+	EventWaiter *next = head->ew_stack_next;
+	head->ew_stack_next = fifo;
+	fifo = head;
+	head = next;
+      }
+
+      while(fifo != 0) {
+	EventWaiter *w = fifo;
+	fifo = w->ew_stack_next;
+	w->ew_stack_next = 0;
+	if(w->ew_stack_gen > cur_gen)
+	  not_ready.push_back(w);
+	else if(is_generation_poisoned(w->ew_stack_gen))
+	  to_wake_poisoned.push_back(w);
+	else
+	  to_wake.push_back(w);
+      }
+    }
+
+    void GenEventImpl::claim_lockfree_waiters(EventWaiter::EventWaiterList& to_wake,
+					      EventWaiter::EventWaiterList& to_wake_poisoned)
+    {
+      EventWaiter *head = lockfree_waiters.exchange(0);
+      if(head == 0)
+	return;
+
+      // waiters that were pushed for the next generation go to the
+      //  mutex-protected list - the owner only advances the generation
+      //  while holding the mutex, so they're guaranteed to be picked up by
+      //  the next trigger
+      EventWaiter::EventWaiterList not_ready;
+      sort_lockfree_waiters(head, generation.load(),
+			    to_wake, to_wake_poisoned, not_ready);
+      current_local_waiters.absorb_append(not_ready);
+    }
+
+    void GenEventImpl::drain_lockfree_waiters(TimeLimit work_until)
+    {
+      EventWaiter::EventWaiterList to_wake, to_wake_poisoned;
+      {
+	AutoLock<> a(mutex);
+	claim_lockfree_waiters(to_wake, to_wake_poisoned);
+      }
+
+      if(!to_wake.empty())
+	get_runtime()->event_triggerer.trigger_event_waiters(to_wake,
+							     false /*!poisoned*/,
+							     work_until);
+      if(!to_wake_poisoned.empty())
+	get_runtime()->event_triggerer.trigger_event_waiters(to_wake_poisoned,
+							     true /*poisoned*/,
+							     work_until);
     }
 
     void GenEventImpl::perform_delayed_free_list_insertion(void)
@@ -2021,8 +2187,12 @@ namespace Realm {
 	}
       }
 
-      if(free_event)
-        GenEventImpl::free_genevent(this);
+      if(free_event) {
+	if(pool != 0)
+	  pool->event_idle(this);
+	else
+	  GenEventImpl::free_genevent(this);
+      }
     }
 
     /*static*/ BarrierImpl *BarrierImpl::create_barrier(unsigned expected_arrivals,
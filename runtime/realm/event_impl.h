@@ -64,6 +64,11 @@ namespace Realm {
       IntrusiveListLink<EventWaiter> ew_list_link;
       REALM_PMTA_DEFN(EventWaiter,IntrusiveListLink<EventWaiter>,ew_list_link);
       typedef IntrusiveList<EventWaiter, REALM_PMTA_USE(EventWaiter,ew_list_link), DummyLock> EventWaiterList;
+
+      // used only while the waiter is on a GenEventImpl's lock-free waiter
+      //  stack (at which point it cannot be in an EventWaiterList)
+      EventWaiter *ew_stack_next;
+      unsigned ew_stack_gen;
     };
 
     // triggering events can often result in recursive expansion of work -
@@ -173,6 +178,17 @@ namespace Realm {
       unsigned num_preconditions, max_preconditions;
     };
 
+    // an alternative to the free list for clients that want to reuse the
+    //  same event objects themselves
+    class GenEventPool {
+    public:
+      virtual ~GenEventPool(void) {}
+
+      // called once a pooled event is done triggering - the pool decides
+      //  whether it can be used for another generation
+      virtual void event_idle(GenEventImpl *impl) = 0;
+    };
+
     class GenEventImpl : public EventImpl {
     public:
       static const ID::ID_Types ID_TYPE = ID::ID_EVENT;
@@ -263,6 +279,30 @@ namespace Realm {
       EventWaiter::EventWaiterList current_local_waiters;
       std::map<gen_t, EventWaiter::EventWaiterList> future_local_waiters;
 
+      // on the owner node, waiters are pushed onto this intrusive stack with
+      //  a compare-and-swap instead of taking the mutex - a trigger swaps out
+      //  the whole stack after updating the generation, and a waiter that
+      //  loses a race with a trigger drains the stack itself
+      // pushes do NOT need the mutex, but the stack is only ever taken (and
+      //  its waiters relinked) while holding it, so a thread holding the
+      //  mutex can safely walk the stack without modifying it
+      atomic<EventWaiter *> lockfree_waiters;
+
+      // splits a chain taken from 'lockfree_waiters' into waiters whose
+      //  generation has triggered (as of 'cur_gen') and those that are still
+      //  waiting, preserving the order in which they were added
+      void sort_lockfree_waiters(EventWaiter *head, gen_t cur_gen,
+				 EventWaiter::EventWaiterList& to_wake,
+				 EventWaiter::EventWaiterList& to_wake_poisoned,
+				 EventWaiter::EventWaiterList& not_ready);
+      // takes the whole lock-free stack, returning the triggered waiters and
+      //  moving the rest to 'current_local_waiters' - must hold mutex
+      void claim_lockfree_waiters(EventWaiter::EventWaiterList& to_wake,
+				  EventWaiter::EventWaiterList& to_wake_poisoned);
+      // claims the lock-free stack and wakes the triggered waiters - must
+      //  NOT hold mutex
+      void drain_lockfree_waiters(TimeLimit work_until);
+
       // external waiters on this node are notifies via a condition variable
       bool has_external_waiters;
       // use kernel mutex for timedwait functionality
@@ -295,6 +335,11 @@ namespace Realm {
       //  poisoned merge and the last precondition
       bool free_list_insertion_delayed;
       friend class EventMerger;
+
+      // set while the event is held by a client-managed pool (e.g. a
+      //  subgraph's instantiation slots) - a triggered event is handed back
+      //  to its pool instead of being put on the free list
+      GenEventPool *pool;
       void perform_delayed_free_list_insertion(void);
     };
 
@@ -613,13 +613,13 @@ namespace Realm {
       }
       return true;
     } else {
-      for(typename std::vector<SparsityMapEntry<N,T> >::const_iterator it = entries.begin();
-	  it != entries.end();
-	  it++) {
-	if(!it->bounds.contains(p)) continue;
-	if(it->sparsity.exists()) {
+      // large maps use an index rather than scanning every entry
+      size_t idx = impl->find_overlapping_entry(Rect<N,T>(p, p));
+      if(idx < entries.size()) {
+	const SparsityMapEntry<N,T>& e = entries[idx];
+	if(e.sparsity.exists()) {
 	  assert(0);
-	} else if(it->bitmap != 0) {
+	} else if(e.bitmap != 0) {
 	  assert(0);
 	} else {
 	  return true;
@@ -643,16 +643,16 @@ namespace Realm {
       size_t total_volume = 0;
       SparsityMapPublicImpl<N,T> *impl = sparsity.impl();
       const std::vector<SparsityMapEntry<N,T> >& entries = impl->get_entries();
-      for(typename std::vector<SparsityMapEntry<N,T> >::const_iterator it = entries.begin();
-	  it != entries.end();
-	  it++) {
-	if(!it->bounds.overlaps(r)) continue;
-	if(it->sparsity.exists()) {
+      for(size_t idx = impl->find_overlapping_entry(r);
+	  idx < entries.size();
+	  idx = impl->find_overlapping_entry(r, idx + 1)) {
+	const SparsityMapEntry<N,T>& e = entries[idx];
+	if(e.sparsity.exists()) {
 	  assert(0);
-	} else if(it->bitmap != 0) {
+	} else if(e.bitmap != 0) {
 	  assert(0);
 	} else {
-          Rect<N,T> isect = it->bounds.intersection(r);
+          Rect<N,T> isect = e.bounds.intersection(r);
           total_volume += isect.volume();
 	}
       }
@@ -676,13 +676,12 @@ namespace Realm {
       // test against sparsity map too
       SparsityMapPublicImpl<N,T> *impl = sparsity.impl();
       const std::vector<SparsityMapEntry<N,T> >& entries = impl->get_entries();
-      for(typename std::vector<SparsityMapEntry<N,T> >::const_iterator it = entries.begin();
-	  it != entries.end();
-	  it++) {
-	if(!it->bounds.overlaps(r)) continue;
-	if(it->sparsity.exists()) {
+      size_t idx = impl->find_overlapping_entry(r);
+      if(idx < entries.size()) {
+	const SparsityMapEntry<N,T>& e = entries[idx];
+	if(e.sparsity.exists()) {
 	  assert(0);
-	} else if(it->bitmap != 0) {
+	} else if(e.bitmap != 0) {
 	  assert(0);
 	} else {
 	  return true;
@@ -1289,11 +1288,12 @@ namespace Realm {
       s_impl = space.sparsity.impl();
       const std::vector<SparsityMapEntry<N,T> >& entries = s_impl->get_entries();
       // find the first entry that overlaps our restriction - speed this up with a
-      //  binary search on the low end of the restriction if we're 1-D
+      //  binary search on the low end of the restriction if we're 1-D, or
+      //  the sparsity map's entry index otherwise
       if(N == 1)
 	cur_entry = bsearch_map_entries(entries, restriction.lo);
       else
-	cur_entry = 0;
+	cur_entry = s_impl->find_overlapping_entry(restriction);
 
       while(cur_entry < entries.size()) {
 	const SparsityMapEntry<N,T>& e = entries[cur_entry];
@@ -1329,11 +1329,12 @@ namespace Realm {
       s_impl = space.sparsity.impl();
       const std::vector<SparsityMapEntry<N,T> >& entries = s_impl->get_entries();
       // find the first entry that overlaps our restriction - speed this up with a
-      //  binary search on the low end of the restriction if we're 1-D
+      //  binary search on the low end of the restriction if we're 1-D, or
+      //  the sparsity map's entry index otherwise
       if(N == 1)
 	cur_entry = bsearch_map_entries(entries, restriction.lo);
       else
-	cur_entry = 0;
+	cur_entry = s_impl->find_overlapping_entry(restriction);
 
       while(cur_entry < entries.size()) {
 	const SparsityMapEntry<N,T>& e = entries[cur_entry];
@@ -1368,6 +1369,12 @@ namespace Realm {
     // move onto the next sparsity entry (that overlaps our restriction)
     const std::vector<SparsityMapEntry<N,T> >& entries = s_impl->get_entries();
     for(cur_entry++; cur_entry < entries.size(); cur_entry++) {
+      // in more than 1-D, the entry index skips the ones that don't overlap
+      if(N > 1) {
+	cur_entry = s_impl->find_overlapping_entry(restriction, cur_entry);
+	if(cur_entry >= entries.size())
+	  break;
+      }
       const SparsityMapEntry<N,T>& e = entries[cur_entry];
       rect = restriction.intersection(e.bounds);
       if(rect.empty()) {
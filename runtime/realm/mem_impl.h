@@ -222,8 +222,10 @@ namespace Realm {
     std::map<TT, unsigned> allocated;  // direct lookup of allocated ranges by tag
 #ifdef DEBUG_REALM
     std::map<RT, unsigned> by_first;   // direct lookup of all ranges by first
-    // TODO: sized-based lookup of free ranges
 #endif
+    // size-based lookup of free ranges, keyed by (size, first) so that the
+    //  best fit (lowest address among equal sizes) is found in O(log n)
+    std::map<std::pair<RT, RT>, unsigned> free_by_size;
 
     static const unsigned SENTINEL = 0;
     // TODO: small (medium?) vector opt
@@ -244,6 +246,15 @@ namespace Realm {
     unsigned first_free_range;
     unsigned alloc_range(RT first, RT last);
     void free_range(unsigned index);
+
+    // maintenance of 'free_by_size' - must be called whenever a free
+    //  range is created/destroyed or changes its bounds
+    void add_free_index(unsigned index);
+    void remove_free_index(unsigned index);
+
+    // finds the smallest free range that can hold an aligned allocation of
+    //  'size', returning SENTINEL if none exists
+    unsigned find_free_range(RT size, RT alignment, RT& ofs) const;
   };
 
     // a memory that manages its own allocations
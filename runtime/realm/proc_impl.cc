@@ -504,6 +504,20 @@ namespace Realm {
       free_local_events.free_entry(e);
     }
 
+    void ProcessorImpl::spawn_pooled_task(Processor::TaskFuncID func_id,
+					  const void *args, size_t arglen,
+					  const ProfilingRequestSet &reqs,
+					  Event start_event,
+					  GenEventImpl *finish_event,
+					  EventImpl::gen_t finish_gen,
+					  int priority,
+					  TaskPool *pool)
+    {
+      // processors that don't build generic tasks just ignore the pool
+      spawn_task(func_id, args, arglen, reqs, start_event,
+		 finish_event, finish_gen, priority);
+    }
+
     void ProcessorImpl::execute_task(Processor::TaskFuncID func_id,
 				     const ByteArrayRef& task_args)
     {
@@ -631,6 +645,7 @@ namespace Realm {
       : ProcessorImpl(Processor::NO_PROC, Processor::PROC_GROUP),
 	members_valid(false), members_requested(false), next_free(0)
       , ready_task_count(0)
+      , next_member_queue(0)
     {
       deferred_spawn_cache.clear();
     }
@@ -638,6 +653,8 @@ namespace Realm {
     ProcessorGroupImpl::~ProcessorGroupImpl(void)
     {
       deferred_spawn_cache.flush();
+      for(size_t i = 0; i < member_queues.size(); i++)
+	delete member_queues[i];
       delete ready_task_count;
     }
 
@@ -672,9 +689,86 @@ namespace Realm {
 	std::string gname = stringbuilder() << "realm/proc " << me << "/ready tasks";
 	ready_task_count = new ProfilingGauges::AbsoluteRangeGauge<int>(gname);
 	task_queue.set_gauge(ready_task_count);
+	AutoLock<> al(member_update_mutex);
+	for(size_t i = 0; i < member_queues.size(); i++)
+	  member_queues[i]->set_gauge(ready_task_count);
       }
     }
 
+    void ProcessorGroupImpl::add_stealing_member(ThreadedTaskScheduler *sched)
+    {
+      AutoLock<> al(member_update_mutex);
+
+      TaskQueue *queue = new TaskQueue;
+      if(ready_task_count)
+	queue->set_gauge(ready_task_count);
+
+      // the new member can steal from all existing members and vice versa
+      for(size_t i = 0; i < member_queues.size(); i++) {
+	sched->add_steal_queue(member_queues[i]);
+	member_schedulers[i]->add_steal_queue(queue);
+      }
+      sched->add_task_queue(queue);
+
+      // only start sending tasks to the queue once somebody will run them
+      {
+	RWLock::AutoWriterLock al2(member_lock);
+	member_queues.push_back(queue);
+	member_schedulers.push_back(sched);
+      }
+    }
+
+    void ProcessorGroupImpl::remove_stealing_member(ThreadedTaskScheduler *sched)
+    {
+      AutoLock<> al(member_update_mutex);
+
+      std::vector<ThreadedTaskScheduler *>::iterator it = std::find(member_schedulers.begin(),
+								    member_schedulers.end(),
+								    sched);
+      assert(it != member_schedulers.end());
+      size_t idx = it - member_schedulers.begin();
+      TaskQueue *queue = member_queues[idx];
+
+      // stop new tasks from going to this queue first - once we have the
+      //  writer lock, nobody can still be in the middle of an enqueue to it
+      {
+	RWLock::AutoWriterLock al2(member_lock);
+	member_queues.erase(member_queues.begin() + idx);
+	member_schedulers.erase(member_schedulers.begin() + idx);
+      }
+
+      // schedulers only look at task/steal queues while holding their own
+      //  locks, so once these return the queue is no longer in use
+      sched->remove_task_queue(queue);
+      for(size_t i = 0; i < member_queues.size(); i++) {
+	sched->remove_steal_queue(member_queues[i]);
+	member_schedulers[i]->remove_steal_queue(queue);
+      }
+
+      // anything left behind is spread over the remaining members' queues
+      //  (or the shared queue if this was the last member) so that it still
+      //  gets run - these tasks have already been marked ready
+      Task::TaskList leftovers;
+      {
+	AutoLock<FIFOMutex> al2(queue->mutex);
+	leftovers.absorb_append(queue->ready_task_list);
+      }
+      if(!leftovers.empty()) {
+	RWLock::AutoReaderLock al2(member_lock);
+	while(!leftovers.empty()) {
+	  Task *task = leftovers.pop_front();
+	  if(ready_task_count)
+	    *ready_task_count -= 1;
+	  if(!member_queues.empty()) {
+	    unsigned target = next_member_queue.fetch_add(1) % member_queues.size();
+	    member_queues[target]->enqueue_ready_task(task);
+	  } else
+	    task_queue.enqueue_ready_task(task);
+	}
+      }
+      delete queue;
+    }
+
     void ProcessorGroupImpl::get_group_members(std::vector<Processor>& member_list)
     {
       assert(members_valid);
@@ -714,12 +808,32 @@ namespace Realm {
 
     void ProcessorGroupImpl::enqueue_task(Task *task)
     {
+      // with task stealing, spread tasks round-robin over the members'
+      //  queues - idle members will steal to even out any imbalance
+      if(Config::use_task_stealing) {
+	RWLock::AutoReaderLock al(member_lock);
+	if(!member_queues.empty()) {
+	  unsigned idx = next_member_queue.fetch_add(1) % member_queues.size();
+	  member_queues[idx]->enqueue_task(task);
+	  return;
+	}
+      }
       task_queue.enqueue_task(task);
     }
 
     void ProcessorGroupImpl::enqueue_tasks(Task::TaskList& tasks,
 					   size_t num_tasks)
     {
+      // a list of tasks shares a single ready marker, so it has to stay
+      //  together in one queue
+      if(Config::use_task_stealing) {
+	RWLock::AutoReaderLock al(member_lock);
+	if(!member_queues.empty()) {
+	  unsigned idx = next_member_queue.fetch_add(1) % member_queues.size();
+	  member_queues[idx]->enqueue_tasks(tasks, num_tasks);
+	  return;
+	}
+      }
       task_queue.enqueue_tasks(tasks, num_tasks);
     }
 
@@ -1035,14 +1149,24 @@ namespace Realm {
 
   void LocalTaskProcessor::add_to_group(ProcessorGroupImpl *group)
   {
-    // add the group's task queue to our scheduler too
-    sched->add_task_queue(&group->task_queue);
+    if(Config::use_task_stealing) {
+      // we get our own queue of the group's tasks and can steal from the
+      //  queues of the other members
+      group->add_stealing_member(sched);
+    } else {
+      // add the group's task queue to our scheduler too
+      sched->add_task_queue(&group->task_queue);
+    }
   }
 
   void LocalTaskProcessor::remove_from_group(ProcessorGroupImpl *group)
   {
-    // remove the group's task queue from our scheduler
-    sched->remove_task_queue(&group->task_queue);
+    if(Config::use_task_stealing) {
+      group->remove_stealing_member(sched);
+    } else {
+      // remove the group's task queue from our scheduler
+      sched->remove_task_queue(&group->task_queue);
+    }
   }
 
   void LocalTaskProcessor::enqueue_task(Task *task)
@@ -1070,6 +1194,21 @@ namespace Realm {
     enqueue_or_defer_task(task, start_event, &deferred_spawn_cache);
   }
 
+  void LocalTaskProcessor::spawn_pooled_task(Processor::TaskFuncID func_id,
+					     const void *args, size_t arglen,
+					     const ProfilingRequestSet &reqs,
+					     Event start_event,
+					     GenEventImpl *finish_event,
+					     EventImpl::gen_t finish_gen,
+					     int priority,
+					     TaskPool *pool)
+  {
+    Task *task = new(pool) Task(me, func_id, args, arglen, reqs,
+				start_event, finish_event, finish_gen, priority);
+
+    enqueue_or_defer_task(task, start_event, &deferred_spawn_cache);
+  }
+
   bool LocalTaskProcessor::register_task(Processor::TaskFuncID func_id,
 					 CodeDescriptor& codedesc,
 					 const ByteArrayRef& user_data)
@@ -62,6 +62,17 @@ namespace Realm {
 			      EventImpl::gen_t finish_gen,
                               int priority) = 0;
 
+      // same as spawn_task, but the task object comes from 'pool' if the
+      //  processor builds its tasks through the generic path
+      virtual void spawn_pooled_task(Processor::TaskFuncID func_id,
+				     const void *args, size_t arglen,
+				     const ProfilingRequestSet &reqs,
+				     Event start_event,
+				     GenEventImpl *finish_event,
+				     EventImpl::gen_t finish_gen,
+				     int priority,
+				     TaskPool *pool);
+
       // starts worker threads and performs any per-processor initialization
       virtual void start_threads(void);
 
@@ -142,6 +153,15 @@ namespace Realm {
 			      EventImpl::gen_t finish_gen,
                               int priority);
 
+      virtual void spawn_pooled_task(Processor::TaskFuncID func_id,
+				     const void *args, size_t arglen,
+				     const ProfilingRequestSet &reqs,
+				     Event start_event,
+				     GenEventImpl *finish_event,
+				     EventImpl::gen_t finish_gen,
+				     int priority,
+				     TaskPool *pool);
+
       virtual bool register_task(Processor::TaskFuncID func_id,
 				 CodeDescriptor& codedesc,
 				 const ByteArrayRef& user_data);
@@ -259,6 +279,11 @@ namespace Realm {
 
       void get_group_members(std::vector<Processor>& member_list);
 
+      // with task stealing enabled, each local member's scheduler is given
+      //  its own queue for the group's tasks and may steal from the others
+      void add_stealing_member(ThreadedTaskScheduler *sched);
+      void remove_stealing_member(ThreadedTaskScheduler *sched);
+
       virtual void enqueue_task(Task *task);
       virtual void enqueue_tasks(Task::TaskList& tasks, size_t num_tasks);
 
@@ -287,6 +312,17 @@ namespace Realm {
       ProfilingGauges::AbsoluteRangeGauge<int> *ready_task_count;
       DeferredSpawnCache deferred_spawn_cache;
 
+      // per-member queues used instead of 'task_queue' with task stealing -
+      //  enqueues hold 'member_lock' as readers so that a member queue
+      //  can't be deleted out from under them, while changes to the member
+      //  lists are serialized by 'member_update_mutex' and only take
+      //  'member_lock' as a writer long enough to update the vectors
+      RWLock member_lock;
+      Mutex member_update_mutex;
+      std::vector<TaskQueue *> member_queues;
+      std::vector<ThreadedTaskScheduler *> member_schedulers;
+      atomic<unsigned> next_member_queue;
+
       class DeferredDestroy : public EventWaiter {
       public:
 	void defer(ProcessorGroupImpl *_pg, Event wait_on);
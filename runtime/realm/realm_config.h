@@ -49,6 +49,15 @@
 #define REALM_USE_LIBAIO
 #endif
 
+// if set, an io_uring-based backend for async file I/O is compiled in - it
+//  is only used if requested with -ll:io_uring and falls back to the above
+//  if the kernel doesn't support it
+#if defined(REALM_ON_LINUX) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define REALM_USE_IO_URING
+#endif
+#endif
+
 // dynamic loading via dlfcn and a not-completely standard dladdr extension
 #ifdef REALM_USE_LIBDL
   #if defined(REALM_ON_LINUX) || defined(REALM_ON_MACOS) || defined(REALM_ON_FREEBSD)
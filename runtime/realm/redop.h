@@ -44,6 +44,11 @@ namespace Realm {
       // both of these are optional
       static const RHS identity;
       void fold(RHS& rhs1, RHS rhs2) const;
+
+      // also optional - set to true if the exclusive apply/fold are pure
+      //  elementwise operations, allowing unit-stride reductions to use
+      //  vectorized loops
+      static const bool is_vectorizable = true;
     };
 #endif
 
@@ -160,6 +165,87 @@ namespace Realm {
           rhs2_ptr = static_cast<const char *>(rhs2_ptr) + rhs2_stride;
         }
       }
+
+      // exclusive variants used for REDOPs that are vectorizable - dense
+      //  (unit stride) ranges are handled by a loop the compiler can turn
+      //  into SIMD code for whatever ISA the application is built for,
+      //  anything else goes through the generic strided loop
+      // the element is updated in a local so that conditional updates
+      //  (e.g. min/max) become selects rather than conditional stores
+      template <typename REDOP>
+      void cpu_apply_vectorized(void *lhs_ptr, size_t lhs_stride,
+                                const void *rhs_ptr, size_t rhs_stride,
+                                size_t count, const void *userdata)
+      {
+        typedef typename REDOP::LHS LHS;
+        typedef typename REDOP::RHS RHS;
+        if((lhs_stride != sizeof(LHS)) || (rhs_stride != sizeof(RHS))) {
+          cpu_apply_wrapper<REDOP, true>(lhs_ptr, lhs_stride, rhs_ptr, rhs_stride,
+                                         count, userdata);
+          return;
+        }
+        const REDOP *redop = static_cast<const REDOP *>(userdata);
+        LHS *lhs = static_cast<LHS *>(lhs_ptr);
+        const RHS *rhs = static_cast<const RHS *>(rhs_ptr);
+        REALM_VECTORIZE_LOOP
+        for(size_t i = 0; i < count; i++) {
+          LHS v = lhs[i];
+          redop->template apply<true>(v, rhs[i]);
+          lhs[i] = v;
+        }
+      }
+
+      template <typename REDOP>
+      void cpu_fold_vectorized(void *rhs1_ptr, size_t rhs1_stride,
+                               const void *rhs2_ptr, size_t rhs2_stride,
+                               size_t count, const void *userdata)
+      {
+        typedef typename REDOP::RHS RHS;
+        if((rhs1_stride != sizeof(RHS)) || (rhs2_stride != sizeof(RHS))) {
+          cpu_fold_wrapper<REDOP, true>(rhs1_ptr, rhs1_stride, rhs2_ptr, rhs2_stride,
+                                        count, userdata);
+          return;
+        }
+        const REDOP *redop = static_cast<const REDOP *>(userdata);
+        RHS *rhs1 = static_cast<RHS *>(rhs1_ptr);
+        const RHS *rhs2 = static_cast<const RHS *>(rhs2_ptr);
+        REALM_VECTORIZE_LOOP
+        for(size_t i = 0; i < count; i++) {
+          RHS v = rhs1[i];
+          redop->template fold<true>(v, rhs2[i]);
+          rhs1[i] = v;
+        }
+      }
+    };
+
+    // the exclusive cpu kernels are replaced with the vectorized versions
+    //  if the REDOP class defines is_vectorizable AND it's true
+    template <typename T>
+    struct HasIsVectorizable {
+      struct YES { char dummy[1]; };
+      struct NO { char dummy[2]; };
+      struct AlternativeDefinition { static const bool is_vectorizable = false; };
+      template <typename T2> struct Combined : public T2, public AlternativeDefinition {};
+      template <typename T2, T2> struct CheckAmbiguous {};
+      template <typename T2> static NO has_member(CheckAmbiguous<const bool *, &Combined<T2>::is_vectorizable> *);
+      template <typename T2> static YES has_member(...);
+      const static bool value = sizeof(has_member<T>(0)) == sizeof(YES);
+    };
+
+    template <typename T, bool OK> struct MaybeUseVectorizedKernels;
+    template <typename T>
+    struct MaybeUseVectorizedKernels<T, false> {
+      static void if_member_exists(ReductionOpUntyped *redop) {};
+      static void if_member_is_true(ReductionOpUntyped *redop) {};
+    };
+    template <typename T>
+    struct MaybeUseVectorizedKernels<T, true> {
+      static void if_member_exists(ReductionOpUntyped *redop) { MaybeUseVectorizedKernels<T, T::is_vectorizable>::if_member_is_true(redop); }
+      static void if_member_is_true(ReductionOpUntyped *redop)
+      {
+        redop->cpu_apply_excl_fn = &ReductionKernels::cpu_apply_vectorized<T>;
+        redop->cpu_fold_excl_fn = &ReductionKernels::cpu_fold_vectorized<T>;
+      }
     };
 
 #if defined(REALM_USE_CUDA) && defined(__CUDACC__)
@@ -240,6 +326,9 @@ namespace Realm {
         cpu_apply_nonexcl_fn = &ReductionKernels::cpu_apply_wrapper<REDOP, false>;
         cpu_fold_excl_fn = &ReductionKernels::cpu_fold_wrapper<REDOP, true>;
         cpu_fold_nonexcl_fn = &ReductionKernels::cpu_fold_wrapper<REDOP, false>;
+        // if REDOP defines/sets 'is_vectorizable' to true, use the vectorized
+        //  kernels for exclusive reductions
+        MaybeUseVectorizedKernels<REDOP, HasIsVectorizable<REDOP>::value>::if_member_exists(this);
 #if defined(REALM_USE_CUDA) && defined(__CUDACC__)
         // if REDOP defines/sets 'has_cuda_reductions' to true, try to
         //  automatically build wrappers for apply_cuda<> and fold_cuda<>
@@ -33,6 +33,7 @@
 
 // remote copy active messages from from lowlevel_dma.h for now
 #include "realm/transfer/lowlevel_dma.h"
+#include "realm/transfer/memcpy_kernels.h"
 
 // create xd message and update bytes read/write messages
 #include "realm/transfer/channel.h"
@@ -1337,11 +1338,14 @@ namespace Realm {
 
       cp.add_option_int("-realm:eventloopcheck", Config::event_loop_detection_limit);
       cp.add_option_bool("-ll:force_kthreads", Config::force_kernel_threads);
+      std::string sched_mode;
+      cp.add_option_string("-ll:sched", sched_mode);
       cp.add_option_bool("-ll:frsrv_fallback", Config::use_fast_reservation_fallback);
       cp.add_option_int("-ll:machine_query_cache", Config::use_machine_query_cache);
       cp.add_option_int("-ll:defalloc", Config::deferred_instance_allocation);
       cp.add_option_int("-ll:amprofile", Config::profile_activemsg_handlers);
       cp.add_option_int("-ll:aminline", Config::max_inline_message_time);
+      cp.add_option_int("-ll:amlanes", Config::activemsg_handler_lanes);
       cp.add_option_int("-ll:ahandlers", active_msg_handler_threads);
       cp.add_option_int("-ll:handler_bgwork", active_msg_handler_bgwork);
       cp.add_option_stringlist("-ll:networks", dummy_network_list);
@@ -1349,6 +1353,15 @@ namespace Realm {
 
       // The default of path_cache_size is 0, when it is set to non-zero, the caching is enabled.
       cp.add_option_int("-ll:path_cache_size", Config::path_cache_lru_size);
+      cp.add_option_int("-ll:io_uring", Config::use_io_uring);
+      cp.add_option_int_units("-ll:io_uring_regmem", Config::io_uring_max_registered, 'm');
+      std::string memcpy_isa;
+      cp.add_option_string("-ll:memcpy_isa", memcpy_isa);
+      cp.add_option_int_units("-ll:memcpy_nt", Config::memcpy_nt_threshold, 'k');
+      cp.add_option_int_units("-ll:memcpy_split", Config::memcpy_split_threshold, 'k');
+      cp.add_option_int("-ll:memcpy_helpers", Config::memcpy_split_helpers);
+      cp.add_option_int_units("-ll:memcpy_transpose", Config::memcpy_transpose_max, 'k');
+      cp.add_option_int("-ll:memcpy_numa", Config::memcpy_numa_queues);
 
       bool cmdline_ok = cp.parse_command_line(cmdline);
 
@@ -1357,6 +1370,35 @@ namespace Realm {
 	exit(1);
       }
 
+      if(sched_mode == "steal") {
+	Config::use_task_stealing = true;
+      } else if(!sched_mode.empty() && (sched_mode != "shared")) {
+	fprintf(stderr, "ERROR: unknown scheduler mode '%s' (expected 'shared' or 'steal')\n",
+		sched_mode.c_str());
+	exit(1);
+      }
+
+      if(!memcpy_isa.empty()) {
+	MemcpyKernels::Variant v;
+	if(!MemcpyKernels::parse_variant(memcpy_isa, v)) {
+	  fprintf(stderr, "ERROR: unknown memcpy kernel '%s' (expected 'auto', 'scalar', 'sse2', 'avx2' or 'avx512')\n",
+		  memcpy_isa.c_str());
+	  exit(1);
+	}
+	if(!MemcpyKernels::is_supported(v)) {
+	  fprintf(stderr, "ERROR: memcpy kernel '%s' is not supported on this cpu\n",
+		  memcpy_isa.c_str());
+	  exit(1);
+	}
+	MemcpyKernels::set_selected(v);
+      }
+
+      if(Config::activemsg_handler_lanes < 1) {
+	fprintf(stderr, "ERROR: -ll:amlanes must be at least 1 (got %d)\n",
+		Config::activemsg_handler_lanes);
+	exit(1);
+      }
+
 #ifndef EVENT_TRACING
       if(!event_trace_file.empty()) {
 	fprintf(stderr, "WARNING: event tracing requested, but not enabled at compile time!\n");
@@ -836,6 +836,8 @@ namespace Realm {
     template void Gauge::add_gauge<AbsoluteGauge<unsigned long> >(AbsoluteGauge<unsigned long>*, SamplingProfiler*);
     template void Gauge::add_gauge<AbsoluteGauge<unsigned> >(AbsoluteGauge<unsigned>*, SamplingProfiler*);
     template void Gauge::add_gauge<AbsoluteRangeGauge<int> >(AbsoluteRangeGauge<int>*, SamplingProfiler*);
+    template void Gauge::add_gauge<AbsoluteRangeGauge<long long> >(AbsoluteRangeGauge<long long>*, SamplingProfiler*);
+    template void Gauge::add_gauge<EventCounter<unsigned long long> >(EventCounter<unsigned long long>*, SamplingProfiler*);
 
   };
 
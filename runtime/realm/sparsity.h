@@ -29,6 +29,7 @@
 
 #include <iostream>
 #include <vector>
+#include <algorithm>
 
 /**
  * \file sparsity.h
@@ -197,10 +198,40 @@ namespace Realm {
    bool compute_covering(const Rect<N, T>& bounds, size_t max_rects,
                          int max_overhead, std::vector<Rect<N, T> >& covering);
 
+   /**
+    * Find the next entry that overlaps a rectangle.
+    * Maps with more than a few entries build a bounding volume hierarchy
+    * over their entries the first time this is called, so that a search
+    * visits only the part of the map near the rectangle instead of every
+    * entry.
+    * @param r the rectangle to test against
+    * @param start the index of the first entry to consider
+    * @return the index of the first entry at or after start that overlaps r,
+    * or the number of entries if there is no such entry
+    */
+   size_t find_overlapping_entry(const Rect<N, T>& r, size_t start = 0);
+
   protected:
+    ~SparsityMapPublicImpl(void);
+
+    // the bounding volume hierarchy - level 0 holds the bounds of each run
+    //  of ENTRY_INDEX_FANOUT consecutive entries, level 1 the bounds of each
+    //  run of that many level 0 boxes, and so on up to a single box
+    struct EntryIndex {
+      std::vector<std::vector<Rect<N,T> > > levels;
+    };
+    static const size_t ENTRY_INDEX_FANOUT = 8;
+    // smaller maps are just scanned
+    static const size_t ENTRY_INDEX_MIN_ENTRIES = 32;
+
+    const EntryIndex *get_entry_index(void);
+    size_t search_entry_index(const EntryIndex *index, int level, size_t node,
+                              size_t span, const Rect<N,T>& r, size_t start);
+
     atomic<bool> entries_valid, approx_valid;
     std::vector<SparsityMapEntry<N,T> > entries;
     std::vector<Rect<N,T> > approx_rects;
+    atomic<EntryIndex *> entry_index;
   };
 
 }; // namespace Realm
@@ -102,6 +102,66 @@ namespace Realm {
     return approx_rects;
   }
 
+  template <int N, typename T>
+  inline size_t SparsityMapPublicImpl<N,T>::find_overlapping_entry(const Rect<N,T>& r,
+                                                                   size_t start /*= 0*/)
+  {
+    const std::vector<SparsityMapEntry<N,T> >& e = get_entries();
+    if(e.size() < ENTRY_INDEX_MIN_ENTRIES) {
+      for(size_t i = start; i < e.size(); i++)
+        if(e[i].bounds.overlaps(r))
+          return i;
+      return e.size();
+    }
+
+    // the next entry is worth a look first, for callers stepping through
+    //  runs of overlapping entries
+    if((start < e.size()) && e[start].bounds.overlaps(r))
+      return start;
+
+    const EntryIndex *index = get_entry_index();
+    int top = index->levels.size() - 1;
+    if((start >= e.size()) || !index->levels[top][0].overlaps(r))
+      return e.size();
+    // the single top box covers every entry
+    size_t span = ENTRY_INDEX_FANOUT;
+    for(int i = 0; i < top; i++)
+      span *= ENTRY_INDEX_FANOUT;
+    return search_entry_index(index, top, 0, span, r, start);
+  }
+
+  // searches the children of 'node' on 'level', which together cover the
+  //  'span' entries starting at node * span
+  template <int N, typename T>
+  inline size_t SparsityMapPublicImpl<N,T>::search_entry_index(const EntryIndex *index,
+                                                               int level, size_t node,
+                                                               size_t span,
+                                                               const Rect<N,T>& r,
+                                                               size_t start)
+  {
+    size_t child_span = span / ENTRY_INDEX_FANOUT;
+    size_t c_lo = node * ENTRY_INDEX_FANOUT;
+    size_t c_hi = c_lo + ENTRY_INDEX_FANOUT;
+    // skip children that only cover entries before 'start'
+    c_lo = std::max(c_lo, start / child_span);
+    if(level == 0) {
+      c_hi = std::min(c_hi, entries.size());
+      for(size_t c = c_lo; c < c_hi; c++)
+        if(entries[c].bounds.overlaps(r))
+          return c;
+    } else {
+      const std::vector<Rect<N,T> >& boxes = index->levels[level - 1];
+      c_hi = std::min(c_hi, boxes.size());
+      for(size_t c = c_lo; c < c_hi; c++)
+        if(boxes[c].overlaps(r)) {
+          size_t idx = search_entry_index(index, level - 1, c, child_span,
+                                          r, start);
+          if(idx < entries.size())
+            return idx;
+        }
+    }
+    return entries.size();
+  }
 
 }; // namespace Realm
 
@@ -17,6 +17,7 @@
 
 #include "realm/subgraph_impl.h"
 #include "realm/runtime_impl.h"
+#include "realm/proc_impl.h"
 
 namespace Realm {
 
@@ -186,6 +187,9 @@ namespace Realm {
 
   SubgraphImpl::SubgraphImpl()
     : me(Subgraph::NO_SUBGRAPH)
+    , num_pooled_events(0)
+    , free_slots(0)
+    , task_pool(0)
   {}
 
   SubgraphImpl::~SubgraphImpl()
@@ -450,6 +454,23 @@ namespace Realm {
       schedule[it->second].op_index = it->first.second;
     }
 
+    // every task gets a pooled finish event and has its processor looked up
+    //  once here rather than on every instantiation
+    num_pooled_events = 0;
+    for(std::vector<SubgraphScheduleEntry>::iterator it = schedule.begin();
+	it != schedule.end();
+	++it) {
+      if(it->op_kind == SubgraphDefinition::OPKIND_TASK) {
+	it->proc_impl = get_runtime()->get_processor_impl(defn->tasks[it->op_index].proc);
+	it->pooled_event_index = num_pooled_events++;
+      } else {
+	it->proc_impl = 0;
+	it->pooled_event_index = 0;
+      }
+    }
+    if(num_pooled_events > 0)
+      task_pool = new TaskPool;
+
     // count number of intermediate events - instantiations can produce more
     //  than one
     num_intermediate_events = 0;
@@ -610,6 +631,9 @@ namespace Realm {
 				 Event start_event, Event finish_event,
 				 int priority_adjust)
   {
+    // task finish events come from an idle instantiation slot
+    SubgraphInstantiationSlot *slot = acquire_slot();
+
     // we precomputed the number of intermediate events we need, so put them
     //  on the stack
     Event *intermediate_events = static_cast<Event *>(alloca(num_intermediate_events *
@@ -698,7 +722,6 @@ namespace Realm {
       case SubgraphDefinition::OPKIND_TASK:
 	{
 	  const SubgraphDefinition::TaskDesc& td = defn->tasks[it->op_index];
-	  Processor proc = td.proc;
 	  Processor::TaskFuncID task_id = td.task_id;
 	  int priority = td.priority;
 
@@ -719,10 +742,14 @@ namespace Realm {
 						   td.args.base(), td.args.size(),
 						   ish);
 
-	  e = proc.spawn(task_id, task_args, td.args.size(),
-			 td.prs,
-			 pre,
-			 priority + priority_adjust);
+	  GenEventImpl *finish_impl;
+	  e = slot->next_event(it->pooled_event_index, finish_impl);
+	  it->proc_impl->spawn_pooled_task(task_id, task_args, td.args.size(),
+					   td.prs,
+					   pre,
+					   finish_impl, ID(e).event_generation(),
+					   priority + priority_adjust,
+					   task_pool);
 	  intermediate_events[cur_intermediate_events++] = e;
 	  break;
 	}
@@ -885,11 +912,69 @@ namespace Realm {
     }
   }
 
+  SubgraphInstantiationSlot *SubgraphImpl::acquire_slot(void)
+  {
+    if(num_pooled_events == 0)
+      return 0;
+
+    SubgraphInstantiationSlot *slot;
+    {
+      AutoLock<> al(slot_mutex);
+      slot = free_slots;
+      if(slot != 0) {
+	free_slots = slot->next_free;
+      } else {
+	// every slot is still in flight - add another one
+	slot = new SubgraphInstantiationSlot(this, num_pooled_events);
+	all_slots.push_back(slot);
+      }
+      slot->in_use = true;
+    }
+    slot->prepare();
+    return slot;
+  }
+
+  void SubgraphImpl::return_slot(SubgraphInstantiationSlot *slot)
+  {
+    {
+      AutoLock<> al(slot_mutex);
+      slot->in_use = false;
+      if(!slot->detached) {
+	slot->next_free = free_slots;
+	free_slots = slot;
+	return;
+      }
+    }
+    // the subgraph was destroyed while this slot was in flight
+    delete slot;
+  }
+
   void SubgraphImpl::destroy(void)
   {
     delete defn;
     schedule.clear();
 
+    // idle slots can go now - in-flight ones delete themselves when their
+    //  last event triggers
+    {
+      AutoLock<> al(slot_mutex);
+      for(std::vector<SubgraphInstantiationSlot *>::iterator it = all_slots.begin();
+	  it != all_slots.end();
+	  ++it) {
+	if((*it)->in_use)
+	  (*it)->detached = true;
+	else
+	  delete *it;
+      }
+      all_slots.clear();
+      free_slots = 0;
+    }
+    num_pooled_events = 0;
+    if(task_pool) {
+      task_pool->release();
+      task_pool = 0;
+    }
+
     // TODO: when we create subgraphs on remote nodes, send a message to the
     //  creator node so they can add it to their free list
     NodeID creator_node = ID(me).subgraph_creator_node();
@@ -901,6 +986,72 @@ namespace Realm {
   }
 
 
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class SubgraphInstantiationSlot
+  //
+
+  // an event can be reused as long as it hasn't run out of generations or
+  //  room to record poisoned generations
+  static bool pooled_event_reusable(GenEventImpl *impl)
+  {
+    return ((impl->generation.load() < ((1U << ID::EVENT_GENERATION_WIDTH) - 1)) &&
+	    (impl->num_poisoned_generations.load() < GenEventImpl::POISONED_GENERATION_LIMIT));
+  }
+
+  SubgraphInstantiationSlot::SubgraphInstantiationSlot(SubgraphImpl *_subgraph,
+						       size_t num_events)
+    : subgraph(_subgraph)
+    , next_free(0)
+    , in_use(false)
+    , detached(false)
+    , events(num_events, 0)
+    , events_pending(0)
+  {
+    for(size_t i = 0; i < num_events; i++) {
+      events[i] = GenEventImpl::create_genevent();
+      events[i]->pool = this;
+    }
+  }
+
+  SubgraphInstantiationSlot::~SubgraphInstantiationSlot(void)
+  {
+    // all events are idle, so they can go back to the runtime
+    for(size_t i = 0; i < events.size(); i++) {
+      events[i]->pool = 0;
+      if(pooled_event_reusable(events[i]))
+	GenEventImpl::free_genevent(events[i]);
+    }
+  }
+
+  void SubgraphInstantiationSlot::prepare(void)
+  {
+    for(size_t i = 0; i < events.size(); i++)
+      if(!pooled_event_reusable(events[i])) {
+	// retire it the same way the free list would (i.e. never reuse it)
+	events[i]->pool = 0;
+	events[i] = GenEventImpl::create_genevent();
+	events[i]->pool = this;
+      }
+
+    // every event is used exactly once per instantiation
+    events_pending.store(events.size());
+  }
+
+  Event SubgraphInstantiationSlot::next_event(unsigned index, GenEventImpl *& impl)
+  {
+    assert(index < events.size());
+    impl = events[index];
+    return impl->current_event();
+  }
+
+  void SubgraphInstantiationSlot::event_idle(GenEventImpl *impl)
+  {
+    if(events_pending.fetch_sub_acqrel(1) == 1)
+      subgraph->return_slot(this);
+  }
+
+
   ////////////////////////////////////////////////////////////////////////
   //
   // class SubgraphImpl::DeferredDestroy
@@ -24,6 +24,10 @@
 
 namespace Realm {
 
+  class ProcessorImpl;
+  class TaskPool;
+  class SubgraphImpl;
+
   struct SubgraphScheduleEntry {
     SubgraphDefinition::OpKind op_kind;
     unsigned op_index;
@@ -31,6 +35,36 @@ namespace Realm {
     unsigned first_interp, num_interps;
     unsigned intermediate_event_base, intermediate_event_count;
     bool is_final_event;
+    // tasks have their processor looked up once at compile time and get
+    //  their finish event from the instantiation slot (at this index)
+    ProcessorImpl *proc_impl;
+    unsigned pooled_event_index;
+  };
+
+  // the event objects used by one in-flight instantiation - once every
+  //  event has triggered, the slot goes back on its subgraph's free list and
+  //  the next instantiation uses the next generation of the same events
+  class SubgraphInstantiationSlot : public GenEventPool {
+  public:
+    SubgraphInstantiationSlot(SubgraphImpl *_subgraph, size_t num_events);
+    virtual ~SubgraphInstantiationSlot(void);
+
+    // replaces any event that has run out of generations or poison slots
+    //  and arms the slot for a new instantiation
+    void prepare(void);
+
+    // gets the next generation of a pooled event for this instantiation
+    Event next_event(unsigned index, GenEventImpl *& impl);
+
+    virtual void event_idle(GenEventImpl *impl);
+
+    SubgraphImpl *subgraph;
+    SubgraphInstantiationSlot *next_free;
+    bool in_use, detached;
+
+  protected:
+    std::vector<GenEventImpl *> events;
+    atomic<size_t> events_pending;
   };
 
   class SubgraphImpl {
@@ -53,6 +87,9 @@ namespace Realm {
 
     void destroy(void);
 
+    SubgraphInstantiationSlot *acquire_slot(void);
+    void return_slot(SubgraphInstantiationSlot *slot);
+
     class DeferredDestroy : public EventWaiter {
     public:
       void defer(SubgraphImpl *_subgraph, Event wait_on);
@@ -71,6 +108,14 @@ namespace Realm {
     std::vector<SubgraphScheduleEntry> schedule;
     size_t num_intermediate_events, num_final_events, max_preconditions;
 
+    // replays reuse event objects and task storage instead of allocating
+    //  new ones every time
+    size_t num_pooled_events;
+    Mutex slot_mutex;
+    SubgraphInstantiationSlot *free_slots;
+    std::vector<SubgraphInstantiationSlot *> all_slots;
+    TaskPool *task_pool;
+
     DeferredDestroy deferred_destroy;
   };
 
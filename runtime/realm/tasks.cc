@@ -22,6 +22,10 @@
 
 namespace Realm {
 
+  namespace Config {
+    bool use_task_stealing = false;
+  };
+
   Logger log_task("task");
   Logger log_sched("sched");
 
@@ -73,6 +77,46 @@ namespace Realm {
     assert(pending_head.load() == 0);
   }
 
+  // the header just records the owning pool, but is padded to keep the task
+  //  object itself suitably aligned
+  static const size_t TASK_STORAGE_HEADER = 16;
+
+  /*static*/ void *Task::operator new(size_t bytes)
+  {
+    return operator new(bytes, static_cast<TaskPool *>(0));
+  }
+
+  /*static*/ void *Task::operator new(size_t bytes, TaskPool *pool)
+  {
+    void *block = 0;
+    if(pool)
+      block = pool->alloc_block(bytes + TASK_STORAGE_HEADER);
+    // fall back to the heap if the pool can't hold this task
+    if(!block) {
+      pool = 0;
+      block = malloc(bytes + TASK_STORAGE_HEADER);
+      assert(block != 0);
+    }
+    *static_cast<TaskPool **>(block) = pool;
+    return static_cast<char *>(block) + TASK_STORAGE_HEADER;
+  }
+
+  /*static*/ void Task::operator delete(void *ptr)
+  {
+    if(!ptr) return;
+    void *block = static_cast<char *>(ptr) - TASK_STORAGE_HEADER;
+    TaskPool *pool = *static_cast<TaskPool **>(block);
+    if(pool)
+      pool->free_block(block);
+    else
+      free(block);
+  }
+
+  /*static*/ void Task::operator delete(void *ptr, TaskPool *pool)
+  {
+    operator delete(ptr);
+  }
+
   void Task::print(std::ostream& os) const
   {
     os << "task(proc=" << proc << ", func=" << func_id << ")";
@@ -412,13 +456,83 @@ namespace Realm {
   }
 
 
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class TaskPool
+  //
+
+  TaskPool::TaskPool(void)
+    : block_size(sizeof(Task) + TASK_STORAGE_HEADER)
+    , outstanding(0)
+    , released(false)
+  {}
+
+  TaskPool::~TaskPool(void)
+  {
+    assert(outstanding == 0);
+    for(std::vector<void *>::iterator it = free_blocks.begin();
+	it != free_blocks.end();
+	++it)
+      free(*it);
+  }
+
+  void TaskPool::release(void)
+  {
+    bool last;
+    {
+      AutoLock<> al(mutex);
+      assert(!released);
+      released = true;
+      last = (outstanding == 0);
+    }
+    if(last)
+      delete this;
+  }
+
+  void *TaskPool::alloc_block(size_t bytes)
+  {
+    if(bytes > block_size)
+      return 0;
+
+    void *block = 0;
+    {
+      AutoLock<> al(mutex);
+      outstanding++;
+      if(!free_blocks.empty()) {
+	block = free_blocks.back();
+	free_blocks.pop_back();
+      }
+    }
+    if(!block) {
+      block = malloc(block_size);
+      assert(block != 0);
+    }
+    return block;
+  }
+
+  void TaskPool::free_block(void *block)
+  {
+    bool last;
+    {
+      AutoLock<> al(mutex);
+      free_blocks.push_back(block);
+      assert(outstanding > 0);
+      outstanding--;
+      last = released && (outstanding == 0);
+    }
+    if(last)
+      delete this;
+  }
+
+
   ////////////////////////////////////////////////////////////////////////
   //
   // class TaskQueue
   //
 
   TaskQueue::TaskQueue(void)
-    : task_count_gauge(0)
+    : top_priority(PRI_NEG_INF)
+    , task_count_gauge(0)
   {}
 
   void TaskQueue::add_subscription(NotificationCallback *callback,
@@ -455,9 +569,16 @@ namespace Realm {
     task_count_gauge = 0;
   }
 
+  void TaskQueue::update_top_priority(void)
+  {
+    top_priority.store(ready_task_list.empty() ? PRI_NEG_INF :
+		                                 ready_task_list.front()->priority);
+  }
+
   // gets highest priority task available from any task queue
   /*static*/ Task *TaskQueue::get_best_task(const std::vector<TaskQueue *>& queues,
-					    int& task_priority)
+					    int& task_priority,
+					    TaskQueue **task_source_out /*= 0*/)
   {
     // remember where a task has come from in case we want to put it back
     Task *task = 0;
@@ -470,20 +591,16 @@ namespace Realm {
       {
 	AutoLock<FIFOMutex> al((*it)->mutex);
 	new_task = (*it)->ready_task_list.pop_front(task_priority+1);
+	if(new_task)
+	  (*it)->update_top_priority();
       }
       if(new_task) {
 	if((*it)->task_count_gauge)
 	  *((*it)->task_count_gauge) -= 1;
 
 	// if we got something better, put back the old thing (if any)
-	if(task) {
-	  {
-	    AutoLock<FIFOMutex> al(task_source->mutex);
-	    task_source->ready_task_list.push_front(task);
-	  }
-	  if(task_source->task_count_gauge)
-	    (*task_source->task_count_gauge) += 1;
-	}
+	if(task)
+	  task_source->requeue_task(task);
 	  
 	task = new_task;
 	task_source = *it;
@@ -491,13 +608,54 @@ namespace Realm {
       }
     }
 
+    if(task_source_out)
+      *task_source_out = task_source;
     return task;
   }
 
-  void TaskQueue::enqueue_task(Task *task)
+  /*static*/ Task *TaskQueue::steal_task(const std::vector<TaskQueue *>& victims,
+					 size_t first_victim, int& task_priority)
   {
-    priority_t notify_priority = PRI_NEG_INF;
+    size_t num_victims = victims.size();
+    for(size_t i = 0; i < num_victims; i++) {
+      TaskQueue *victim = victims[(first_victim + i) % num_victims];
 
+      // don't bother taking the lock unless the victim appears to have
+      //  something better than what we've already got
+      if(victim->top_priority.load() <= task_priority)
+	continue;
+
+      Task *task;
+      {
+	AutoLock<FIFOMutex> al(victim->mutex);
+	task = victim->ready_task_list.pop_front(task_priority+1);
+	if(task)
+	  victim->update_top_priority();
+      }
+      if(task) {
+	if(victim->task_count_gauge)
+	  *(victim->task_count_gauge) -= 1;
+	task_priority = task->priority;
+	return task;
+      }
+    }
+
+    return 0;
+  }
+
+  void TaskQueue::requeue_task(Task *task)
+  {
+    {
+      AutoLock<FIFOMutex> al(mutex);
+      ready_task_list.push_front(task);
+      update_top_priority();
+    }
+    if(task_count_gauge)
+      *task_count_gauge += 1;
+  }
+
+  void TaskQueue::enqueue_task(Task *task)
+  {
     // just jam it into the task queue
     if(task->mark_ready()) {
 //#ifdef DEBUG_REALM
@@ -505,24 +663,32 @@ namespace Realm {
       assert(task->pending_head.load() == 0);
 //#endif
 
-      {
-	AutoLock<FIFOMutex> al(mutex);
-	if(ready_task_list.empty(task->priority))
-	  notify_priority = task->priority;
-	ready_task_list.push_back(task);
-      }
-
-      if(task_count_gauge)
-	*task_count_gauge += 1;
-
-      if(notify_priority > PRI_NEG_INF)
-	for(size_t i = 0; i < callbacks.size(); i++)
-	  if(notify_priority >= callback_priorities[i])
-	    callbacks[i]->item_available(notify_priority);
+      enqueue_ready_task(task);
     } else
       task->mark_finished(false /*!successful*/);
   }
 
+  void TaskQueue::enqueue_ready_task(Task *task)
+  {
+    priority_t notify_priority = PRI_NEG_INF;
+
+    {
+      AutoLock<FIFOMutex> al(mutex);
+      if(ready_task_list.empty(task->priority))
+	notify_priority = task->priority;
+      ready_task_list.push_back(task);
+      update_top_priority();
+    }
+
+    if(task_count_gauge)
+      *task_count_gauge += 1;
+
+    if(notify_priority > PRI_NEG_INF)
+      for(size_t i = 0; i < callbacks.size(); i++)
+	if(notify_priority >= callback_priorities[i])
+	  callbacks[i]->item_available(notify_priority);
+  }
+
   void TaskQueue::enqueue_tasks(Task::TaskList& tasks, size_t num_tasks)
   {
     // early out if there are no tasks to add
@@ -559,6 +725,7 @@ namespace Realm {
 	notify_priority = PRI_NEG_INF;
       // absorb new list into ours
       ready_task_list.absorb_append(tasks);
+      update_top_priority();
     }
 
     if(task_count_gauge)
@@ -696,6 +863,9 @@ namespace Realm {
   {
     // hook up the work counter updates for the resumable worker queue
     resumable_workers.add_subscription(&wcu_resume_queue);
+
+    // different schedulers should pick different first victims
+    steal_seed = unsigned(reinterpret_cast<uintptr_t>(this) >> 4) | 1;
   }
 
   ThreadedTaskScheduler::~ThreadedTaskScheduler(void)
@@ -731,6 +901,29 @@ namespace Realm {
     queue->remove_subscription(&wcu_task_queues);
   }
 
+  void ThreadedTaskScheduler::add_steal_queue(TaskQueue *queue)
+  {
+    AutoLock<FIFOMutex> al(lock);
+
+    steal_queues.push_back(queue);
+
+    // we need to hear about new work in the queue too, or idle workers
+    //  would sleep through a backlog on a busy victim
+    queue->add_subscription(&wcu_task_queues);
+  }
+
+  void ThreadedTaskScheduler::remove_steal_queue(TaskQueue *queue)
+  {
+    AutoLock<FIFOMutex> al(lock);
+    std::vector<TaskQueue *>::iterator it = std::find(steal_queues.begin(),
+						      steal_queues.end(),
+						      queue);
+    if(it != steal_queues.end())
+      steal_queues.erase(it);
+
+    queue->remove_subscription(&wcu_task_queues);
+  }
+
   void ThreadedTaskScheduler::add_task_context(const TaskContextManager *_manager)
   {
     AutoLock<FIFOMutex> al(lock);
@@ -1066,7 +1259,26 @@ namespace Realm {
 
 	// try to get a new task then
 	int task_priority = resumable_priority;
-	Task *task = TaskQueue::get_best_task(task_queues, task_priority);
+	TaskQueue *task_source = 0;
+	Task *task = TaskQueue::get_best_task(task_queues, task_priority,
+					      &task_source);
+
+	// if we're allowed to steal, look for something better than what we
+	//  found locally, starting from a pseudo-random victim so that idle
+	//  workers don't all pile onto the same queue
+	if(!steal_queues.empty()) {
+	  steal_seed ^= steal_seed << 13;
+	  steal_seed ^= steal_seed >> 17;
+	  steal_seed ^= steal_seed << 5;
+	  Task *stolen = TaskQueue::steal_task(steal_queues,
+					       steal_seed % steal_queues.size(),
+					       task_priority);
+	  if(stolen) {
+	    if(task)
+	      task_source->requeue_task(task);
+	    task = stolen;
+	  }
+	}
 
 	// did we find work to do?
 	if(task) {
@@ -33,7 +33,15 @@
 
 namespace Realm {
 
+    namespace Config {
+      // if true, tasks enqueued on a processor group are spread over
+      //  per-member queues and idle members steal from each other instead
+      //  of all members sharing a single queue (set with -ll:sched steal)
+      extern bool use_task_stealing;
+    };
+
     class ProcessorImpl;
+    class TaskPool;
   
     // information for a task launch
     class Task : public Operation {
@@ -51,6 +59,14 @@ namespace Realm {
       virtual ~Task(void);
 
     public:
+      // task storage normally comes from the heap, but can instead be
+      //  carved out of a TaskPool - either way, a small header in front of
+      //  the object remembers where it has to go back to
+      static void *operator new(size_t bytes);
+      static void *operator new(size_t bytes, TaskPool *pool);
+      static void operator delete(void *ptr);
+      static void operator delete(void *ptr, TaskPool *pool);
+
       virtual bool mark_ready(void);
       virtual bool mark_started(void);
 
@@ -123,6 +139,31 @@ namespace Realm {
       atomic<uintptr_t> pending_head;
     };
 
+    // recycles the storage of Task objects for a client that launches the
+    //  same tasks over and over (e.g. subgraph replay) - a task's block goes
+    //  back to the pool when the task is deleted, and the pool itself is
+    //  deleted once its owner has released it and every block has come back
+    class TaskPool {
+    public:
+      TaskPool(void);
+
+      // called by the owner instead of deleting the pool
+      void release(void);
+
+      // returns 0 if 'bytes' is larger than the pool's block size
+      void *alloc_block(size_t bytes);
+      void free_block(void *block);
+
+    protected:
+      ~TaskPool(void);
+
+      size_t block_size;
+      Mutex mutex;
+      std::vector<void *> free_blocks;
+      size_t outstanding;
+      bool released;
+    };
+
     class TaskQueue {
     public:
       TaskQueue(void);
@@ -144,6 +185,10 @@ namespace Realm {
       // starvation seems to be a problem on shared task queues
       FIFOMutex mutex;
       Task::TaskList ready_task_list;
+      // priority of the best task in the queue (or PRI_NEG_INF if empty) -
+      //  only updated while holding the mutex, but can be read without it
+      //  as a hint of whether the queue is worth stealing from
+      atomic<priority_t> top_priority;
       std::vector<NotificationCallback *> callbacks;
       std::vector<priority_t> callback_priorities;
       ProfilingGauges::AbsoluteRangeGauge<int> *task_count_gauge;
@@ -156,11 +201,31 @@ namespace Realm {
 
       void free_gauge();
       // gets highest priority task available from any task queue in list
+      //  (and optionally which queue it came from)
       static Task *get_best_task(const std::vector<TaskQueue *>& queues,
-				 int& task_priority);
+				 int& task_priority,
+				 TaskQueue **task_source = 0);
+
+      // takes a task with priority higher than 'task_priority' from one of
+      //  the 'victims', checking them round-robin starting at 'first_victim'
+      //  and only locking queues whose top priority looks good enough
+      static Task *steal_task(const std::vector<TaskQueue *>& victims,
+			      size_t first_victim, int& task_priority);
 
       void enqueue_task(Task *task);
       void enqueue_tasks(Task::TaskList& tasks, size_t num_tasks);
+
+      // enqueues a task that has already been marked ready (e.g. one moved
+      //  over from another queue)
+      void enqueue_ready_task(Task *task);
+
+      // puts back a task obtained from get_best_task/steal_task that the
+      //  caller decided not to run
+      void requeue_task(Task *task);
+
+    protected:
+      // must be called with mutex held
+      void update_top_priority(void);
     };
 
     // an internal task is an arbitrary blob of work that needs to happen on
@@ -207,6 +272,13 @@ namespace Realm {
 
       virtual void remove_task_queue(TaskQueue *queue);
 
+      // steal queues are task queues owned by other schedulers (e.g. the
+      //  per-member queues of a processor group) that this scheduler may
+      //  take work from when it has nothing better to do
+      void add_steal_queue(TaskQueue *queue);
+
+      void remove_steal_queue(TaskQueue *queue);
+
       virtual void configure_bgworker(BackgroundWorkManager *manager,
 				      long long max_timeslice,
 				      int numa_domain);
@@ -252,6 +324,9 @@ namespace Realm {
       //  contention
       FIFOMutex lock;
       std::vector<TaskQueue *> task_queues;
+      std::vector<TaskQueue *> steal_queues;
+      // state for picking the first steal victim (protected by lock)
+      unsigned steal_seed;
       std::vector<Thread *> idle_workers;
       std::set<Thread *> blocked_workers;
       // threads that block while holding a scheduler lock go here instead
@@ -25,6 +25,7 @@
 #include "realm/transfer/transfer.h"
 #include "realm/transfer/lowlevel_dma.h"
 #include "realm/transfer/ib_memory.h"
+#include "realm/transfer/memcpy_kernels.h"
 #include "realm/utils.h"
 
 #include <algorithm>
@@ -54,6 +55,17 @@ namespace Realm {
 			      uintptr_t src_base, uintptr_t src_lstride,
 			      size_t bytes, size_t lines)
   {
+    // single-element lines (e.g. one field of an AOS instance) are common
+    //  enough to avoid the overhead of a std::copy per element
+    if(bytes == sizeof(T)) {
+      for(size_t i = 0; i < lines; i++) {
+	*reinterpret_cast<T *>(dst_base) = *reinterpret_cast<const T *>(src_base);
+	src_base += src_lstride;
+	dst_base += dst_lstride;
+      }
+      return;
+    }
+
     for(size_t i = 0; i < lines; i++) {
       std::copy(reinterpret_cast<const T *>(src_base),
 		reinterpret_cast<const T *>(src_base + bytes),
@@ -140,9 +152,39 @@ namespace Realm {
   REALM_ALIGNED_TYPE_CONST(aligned_16b_t, dummy_16b_t, 16);
   REALM_ALIGNED_TYPE_CONST(aligned_32b_t, dummy_32b_t, 32);
 
+  // decides whether a copy with rows of 'bytes' bytes should use one of the
+  //  explicit SIMD kernels - VARIANT_SCALAR means use the typed copies above
+  static MemcpyKernels::Variant choose_memcpy_kernel(size_t bytes,
+						     bool nontemporal)
+  {
+    // short rows aren't worth the head/tail handling
+    if(bytes < 256)
+      return MemcpyKernels::VARIANT_SCALAR;
+    MemcpyKernels::Variant v = MemcpyKernels::get_selected();
+    if(v == MemcpyKernels::VARIANT_AUTO) {
+      // the compiler/libc copies are already vectorized, so our own
+      //  kernels are only needed for streaming stores
+      if(!nontemporal)
+	return MemcpyKernels::VARIANT_SCALAR;
+      v = MemcpyKernels::best_supported();
+    }
+    return v;
+  }
+
   void memcpy_1d(uintptr_t dst_base, uintptr_t src_base,
-                 size_t bytes)
+                 size_t bytes, bool nontemporal = false)
   {
+    MemcpyKernels::Variant kernel = choose_memcpy_kernel(bytes, nontemporal);
+    if(kernel != MemcpyKernels::VARIANT_SCALAR) {
+      MemcpyKernels::copy(kernel,
+			  reinterpret_cast<void *>(dst_base),
+			  reinterpret_cast<const void *>(src_base),
+			  bytes, nontemporal);
+      if(nontemporal)
+	MemcpyKernels::store_fence();
+      return;
+    }
+
     // by subtracting 1 from bases, strides, and lengths, we get LSBs set
     //  based on the common alignment of every parameter in the copy
     unsigned alignment = ((dst_base - 1) & (src_base - 1) &
@@ -171,8 +213,20 @@ namespace Realm {
 
   void memcpy_2d(uintptr_t dst_base, uintptr_t dst_lstride,
                  uintptr_t src_base, uintptr_t src_lstride,
-                 size_t bytes, size_t lines)
+                 size_t bytes, size_t lines, bool nontemporal = false)
   {
+    MemcpyKernels::Variant kernel = choose_memcpy_kernel(bytes, nontemporal);
+    if(kernel != MemcpyKernels::VARIANT_SCALAR) {
+      for(size_t i = 0; i < lines; i++)
+	MemcpyKernels::copy(kernel,
+			    reinterpret_cast<void *>(dst_base + (i * dst_lstride)),
+			    reinterpret_cast<const void *>(src_base + (i * src_lstride)),
+			    bytes, nontemporal);
+      if(nontemporal)
+	MemcpyKernels::store_fence();
+      return;
+    }
+
     // by subtracting 1 from bases, strides, and lengths, we get LSBs set
     //  based on the common alignment of every parameter in the copy
     unsigned alignment = ((dst_base - 1) & (dst_lstride - 1) &
@@ -214,7 +268,8 @@ namespace Realm {
                  uintptr_t dst_pstride,
                  uintptr_t src_base, uintptr_t src_lstride,
                  uintptr_t src_pstride,
-                 size_t bytes, size_t lines, size_t planes)
+                 size_t bytes, size_t lines, size_t planes,
+                 bool nontemporal = false)
   {
     // by subtracting 1 from bases, strides, and lengths, we get LSBs set
     //  based on the common alignment of every parameter in the copy
@@ -243,6 +298,22 @@ namespace Realm {
       std::swap(src_pstride, src_lstride);
       std::swap(planes, lines);
     }
+    MemcpyKernels::Variant kernel = choose_memcpy_kernel(bytes, nontemporal);
+    if(kernel != MemcpyKernels::VARIANT_SCALAR) {
+      for(size_t j = 0; j < planes; j++)
+	for(size_t i = 0; i < lines; i++)
+	  MemcpyKernels::copy(kernel,
+			      reinterpret_cast<void *>(dst_base +
+						       (j * dst_pstride) +
+						       (i * dst_lstride)),
+			      reinterpret_cast<const void *>(src_base +
+							     (j * src_pstride) +
+							     (i * src_lstride)),
+			      bytes, nontemporal);
+      if(nontemporal)
+	MemcpyKernels::store_fence();
+      return;
+    }
     // TODO: consider jump table approach?
     if((alignment & 31) == 31)
       memcpy_3d_typed<aligned_32b_t>(dst_base, dst_lstride, dst_pstride,
@@ -270,6 +341,198 @@ namespace Realm {
 			       bytes, lines, planes);
   }
 
+  // transposing copies (e.g. AOS <-> SOA) move the same number of elements
+  //  for several fields - walking all the fields for a tile of elements at a
+  //  time means each cache line of the interleaved side is only brought in
+  //  once rather than once per field
+  template <typename T>
+  static void transpose_fields_typed(size_t num_fields,
+				     const uintptr_t *dst_bases,
+				     uintptr_t dst_stride,
+				     const uintptr_t *src_bases,
+				     uintptr_t src_stride,
+				     size_t count, size_t tile)
+  {
+    for(size_t p0 = 0; p0 < count; p0 += tile) {
+      size_t p1 = std::min(count, p0 + tile);
+      for(size_t f = 0; f < num_fields; f++) {
+	uintptr_t dst = dst_bases[f] + (p0 * dst_stride);
+	uintptr_t src = src_bases[f] + (p0 * src_stride);
+	for(size_t p = p0; p < p1; p++) {
+	  *reinterpret_cast<T *>(dst) = *reinterpret_cast<const T *>(src);
+	  // manual strength reduction
+	  dst += dst_stride;
+	  src += src_stride;
+	}
+      }
+    }
+  }
+
+  static void transpose_fields(size_t num_fields,
+			       const uintptr_t *dst_bases, uintptr_t dst_stride,
+			       const uintptr_t *src_bases, uintptr_t src_stride,
+			       size_t elem_size, size_t count)
+  {
+    // size tiles so the interleaved side of a tile stays in L1
+    static const size_t TILE_BYTES = 16384;
+    size_t tile = std::max(size_t(16),
+			   TILE_BYTES / std::max(dst_stride, src_stride));
+
+    // everything has to be aligned to the element size for the typed copies
+    uintptr_t alignment = (dst_stride | src_stride | elem_size);
+    for(size_t f = 0; f < num_fields; f++)
+      alignment |= (dst_bases[f] | src_bases[f]);
+
+    switch(elem_size) {
+    case 1:
+      transpose_fields_typed<uint8_t>(num_fields, dst_bases, dst_stride,
+				      src_bases, src_stride, count, tile);
+      return;
+    case 2:
+      if((alignment & 1) == 0) {
+	transpose_fields_typed<uint16_t>(num_fields, dst_bases, dst_stride,
+					 src_bases, src_stride, count, tile);
+	return;
+      }
+      break;
+    case 4:
+      if((alignment & 3) == 0) {
+	transpose_fields_typed<uint32_t>(num_fields, dst_bases, dst_stride,
+					 src_bases, src_stride, count, tile);
+	return;
+      }
+      break;
+    case 8:
+      if((alignment & 7) == 0) {
+	transpose_fields_typed<uint64_t>(num_fields, dst_bases, dst_stride,
+					 src_bases, src_stride, count, tile);
+	return;
+      }
+      break;
+    case 16:
+      if((alignment & 15) == 0) {
+	transpose_fields_typed<aligned_16b_t>(num_fields, dst_bases, dst_stride,
+					      src_bases, src_stride,
+					      count, tile);
+	return;
+      }
+      break;
+    default:
+      break;
+    }
+
+    // odd sizes/alignments - still tile, but use 2d copies for each piece
+    for(size_t p0 = 0; p0 < count; p0 += tile) {
+      size_t lines = std::min(tile, count - p0);
+      for(size_t f = 0; f < num_fields; f++)
+	memcpy_2d(dst_bases[f] + (p0 * dst_stride), dst_stride,
+		  src_bases[f] + (p0 * src_stride), src_stride,
+		  elem_size, lines);
+    }
+  }
+
+  // describes an address list entry as 'count' elements of 'elem_size'
+  //  bytes each, 'stride' bytes apart, if possible
+  static bool entry_as_elements(const size_t *entry, size_t elem_size,
+				size_t& count, uintptr_t& stride)
+  {
+    int dim = (entry[0] & 15);
+    size_t contig_bytes = (entry[0] >> 4);
+    if(dim == 1) {
+      // dense - any multiple of the element size works
+      if((contig_bytes % elem_size) != 0)
+	return false;
+      count = contig_bytes / elem_size;
+      stride = elem_size;
+      return true;
+    }
+    if((dim == 2) && (contig_bytes == elem_size)) {
+      count = entry[2];
+      stride = entry[3];
+      return true;
+    }
+    return false;
+  }
+
+  // looks for a run of address list entries (i.e. fields) that are the same
+  //  shape on each side with at least one side interleaved, and copies as
+  //  many of them as fit in 'max_bytes' with a single transposing copy -
+  //  returns the number of bytes copied (0 if the fast path doesn't apply)
+  static size_t try_transposing_copy(AddressListCursor& in_alc,
+				     AddressListCursor& out_alc,
+				     uintptr_t in_base, uintptr_t out_base,
+				     size_t max_bytes)
+  {
+    static const int MAX_FIELDS = 64;
+    const size_t *in_entries[MAX_FIELDS];
+    const size_t *out_entries[MAX_FIELDS];
+
+    // check the shape of the current entries before looking any further
+    if((in_alc.peek_entries(in_entries, 1) == 0) ||
+       (out_alc.peek_entries(out_entries, 1) == 0))
+      return 0;
+
+    // the interleaved side tells us the element size
+    size_t elem_size;
+    int in_dim = (in_entries[0][0] & 15);
+    int out_dim = (out_entries[0][0] & 15);
+    if(in_dim == 2)
+      elem_size = (in_entries[0][0] >> 4);
+    else if(out_dim == 2)
+      elem_size = (out_entries[0][0] >> 4);
+    else
+      return 0;
+
+    size_t count, in_count, out_count;
+    uintptr_t in_stride, out_stride;
+    if(!entry_as_elements(in_entries[0], elem_size, count, in_stride) ||
+       !entry_as_elements(out_entries[0], elem_size, out_count, out_stride) ||
+       (out_count != count))
+      return 0;
+    // fully-contiguous on both sides is handled fine by the normal path
+    if((in_stride == elem_size) && (out_stride == elem_size))
+      return 0;
+
+    size_t field_bytes = count * elem_size;
+    if((2 * field_bytes) > max_bytes)
+      return 0;
+
+    // now gather as many matching fields as we can
+    int max_fields = std::min(std::min(in_alc.peek_entries(in_entries,
+							   MAX_FIELDS),
+				       out_alc.peek_entries(out_entries,
+							    MAX_FIELDS)),
+			      int(max_bytes / field_bytes));
+    uintptr_t in_bases[MAX_FIELDS];
+    uintptr_t out_bases[MAX_FIELDS];
+    int num_fields = 0;
+    while(num_fields < max_fields) {
+      uintptr_t s1, s2;
+      if(!entry_as_elements(in_entries[num_fields], elem_size,
+			    in_count, s1) ||
+	 !entry_as_elements(out_entries[num_fields], elem_size,
+			    out_count, s2) ||
+	 (in_count != count) || (out_count != count) ||
+	 (s1 != in_stride) || (s2 != out_stride))
+	break;
+      in_bases[num_fields] = in_base + in_entries[num_fields][1];
+      out_bases[num_fields] = out_base + out_entries[num_fields][1];
+      num_fields++;
+    }
+    // a single field is just a strided copy
+    if(num_fields < 2)
+      return 0;
+
+    transpose_fields(num_fields, out_bases, out_stride,
+		     in_bases, in_stride, elem_size, count);
+
+    for(int i = 0; i < num_fields; i++) {
+      in_alc.skip_entry();
+      out_alc.skip_entry();
+    }
+    return num_fields * field_bytes;
+  }
+
   void memset_1d(uintptr_t dst_base, size_t bytes,
                  const void *fill_data, size_t fill_size)
   {
@@ -894,6 +1157,45 @@ namespace Realm {
     }
   }
 
+  int AddressListCursor::peek_entries(const size_t **entries,
+				      int max_entries) const
+  {
+    assert(addrlist);
+    if(partial)
+      return 0;
+
+    // walk the entries the same way read_entry does, using the pending byte
+    //  count to know when to stop
+    unsigned ptr = addrlist->read_pointer;
+    size_t bytes_left = addrlist->total_bytes;
+    int count = 0;
+    while((count < max_entries) && (bytes_left > 0)) {
+      if((ptr >= AddressList::MAX_ENTRIES) || (addrlist->data[ptr] == 0))
+	ptr = 0;
+      const size_t *entry = addrlist->data + ptr;
+      int act_dim = (entry[0] & 15);
+      size_t bytes = (entry[0] >> 4);
+      for(int i = 1; i < act_dim; i++)
+	bytes *= entry[2 * i];
+      assert(bytes <= bytes_left);
+      entries[count++] = entry;
+      bytes_left -= bytes;
+      ptr += 2 * act_dim;
+    }
+    return count;
+  }
+
+  void AddressListCursor::skip_entry()
+  {
+    assert(!partial);
+    const size_t *entry = addrlist->read_entry();
+    int act_dim = (entry[0] & 15);
+    if(act_dim == 1)
+      advance(0, (entry[0] >> 4));
+    else
+      advance(act_dim - 1, entry[2 * (act_dim - 1)]);
+  }
+
   std::ostream& operator<<(std::ostream& os, const AddressListCursor& alc)
   {
     os << alc.remaining(0);
@@ -2873,6 +3175,14 @@ namespace Realm {
   // class MemcpyXferDes
   //
 
+      // returns the numa domain of a cpu-accessible memory, or -1 if it
+      //  doesn't have one
+      static int memory_numa_domain(MemoryImpl *mem)
+      {
+	LocalCPUMemory *cpu_mem = dynamic_cast<LocalCPUMemory *>(mem);
+	return (cpu_mem ? cpu_mem->numa_node : -1);
+      }
+
       MemcpyXferDes::MemcpyXferDes(uintptr_t _dma_op, Channel *_channel,
 				   NodeID _launch_node, XferDesID _guid,
 				   const std::vector<XferDesPortInfo>& inputs_info,
@@ -2896,6 +3206,14 @@ namespace Realm {
 
 	// ignore requested max_nr and always use 1
 	memcpy_req.xd = this;
+
+	// the destination matters more (writes to remote memory are costlier),
+	//  but use the source's domain if the destination doesn't have one
+	numa_domain = -1;
+	if(!output_ports.empty())
+	  numa_domain = memory_numa_domain(output_ports[0].mem);
+	if((numa_domain < 0) && !input_ports.empty())
+	  numa_domain = memory_numa_domain(input_ports[0].mem);
       }
 
       long MemcpyXferDes::get_requests(Request** requests, long nr)
@@ -3052,6 +3370,11 @@ namespace Realm {
 	      log_xd.info() << "memcpy chunk: min=" << min_xfer_size
 			    << " max=" << max_bytes;
 
+	      // a transfer this big won't fit in cache anyway, so don't
+	      //  evict everything else to make room for the destination
+	      bool nontemporal = ((Config::memcpy_nt_threshold > 0) &&
+				  (max_bytes >= Config::memcpy_nt_threshold));
+
 	      uintptr_t in_base = reinterpret_cast<uintptr_t>(in_port->mem->get_direct_ptr(0, 0));
 	      uintptr_t out_base = reinterpret_cast<uintptr_t>(out_port->mem->get_direct_ptr(0, 0));
 
@@ -3059,6 +3382,20 @@ namespace Realm {
 		AddressListCursor& in_alc = in_port->addrcursor;
 		AddressListCursor& out_alc = out_port->addrcursor;
 
+		// copies between AOS and SOA layouts show up as one strided
+		//  entry per field - try to move a group of fields at once
+		if(Config::memcpy_transpose_max > 0) {
+		  size_t bytes = try_transposing_copy(in_alc, out_alc,
+						      in_base, out_base,
+						      std::min(max_bytes - total_bytes,
+							       Config::memcpy_transpose_max));
+		  if(bytes > 0) {
+		    total_bytes += bytes;
+		    if((total_bytes >= min_xfer_size) && work_until.is_expired()) break;
+		    continue;
+		  }
+		}
+
 		uintptr_t in_offset = in_alc.get_offset();
 		uintptr_t out_offset = out_alc.get_offset();
 
@@ -3071,8 +3408,9 @@ namespace Realm {
 		size_t bytes_left = max_bytes - total_bytes;
 		// memcpys don't need to be particularly big to achieve
 		//  peak efficiency, so trim to something that takes
-		//  10's of us to be responsive to the time limit
-		bytes_left = std::min(bytes_left, size_t(256 << 10));
+		//  10's of us to be responsive to the time limit (unless
+		//  there are helpers to split the copy with)
+		bytes_left = std::min(bytes_left, channel->max_copy_chunk(work_until));
 
 		if(in_dim > 0) {
 		  if(out_dim > 0) {
@@ -3088,9 +3426,9 @@ namespace Realm {
 		       ((contig_bytes == icount) && (in_dim == 1)) ||
 		       ((contig_bytes == ocount) && (out_dim == 1))) {
 		      bytes = contig_bytes;
-		      memcpy_1d(out_base + out_offset,
-				in_base + in_offset,
-				bytes);
+		      channel->copy_block(out_base + out_offset, 0, 0,
+					  in_base + in_offset, 0, 0,
+					  bytes, 1, 1, nontemporal);
 		      in_alc.advance(0, bytes);
 		      out_alc.advance(0, bytes);
 		    } else {
@@ -3143,9 +3481,9 @@ namespace Realm {
 			 ((lines == icount) && (id == (in_dim - 1))) ||
 			 ((lines == ocount) && (od == (out_dim - 1)))) {
 			bytes = contig_bytes * lines;
-			memcpy_2d(out_base + out_offset, out_lstride,
-				  in_base + in_offset, in_lstride,
-				  contig_bytes, lines);
+			channel->copy_block(out_base + out_offset, out_lstride, 0,
+					    in_base + in_offset, in_lstride, 0,
+					    contig_bytes, lines, 1, nontemporal);
 			in_alc.advance(id, lines * iscale);
 			out_alc.advance(od, lines * oscale);
 		      } else {
@@ -3186,9 +3524,9 @@ namespace Realm {
 						  (contig_bytes * lines)));
 
 			bytes = contig_bytes * lines * planes;
-			memcpy_3d(out_base + out_offset, out_lstride, out_pstride,
-				  in_base + in_offset, in_lstride, in_pstride,
-				  contig_bytes, lines, planes);
+			channel->copy_block(out_base + out_offset, out_lstride, out_pstride,
+					    in_base + in_offset, in_lstride, in_pstride,
+					    contig_bytes, lines, planes, nontemporal);
 			in_alc.advance(id, planes * iscale);
 			out_alc.advance(od, planes * oscale);
 		      }
@@ -5134,6 +5472,135 @@ namespace Realm {
       }
 
 
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // struct MemcpySplitJob
+  //
+
+      // a large copy broken into pieces along its outermost dimension - the
+      //  thread that posts it and any helpers that show up claim pieces
+      //  until they run out
+      struct MemcpySplitJob {
+	MemcpySplitJob(uintptr_t _dst_base, uintptr_t _dst_lstride,
+		       uintptr_t _dst_pstride,
+		       uintptr_t _src_base, uintptr_t _src_lstride,
+		       uintptr_t _src_pstride,
+		       size_t _bytes, size_t _lines, size_t _planes,
+		       bool _nontemporal, size_t max_pieces);
+
+	// returns false if there were no pieces left to claim
+	bool do_one_piece(void);
+
+	uintptr_t dst_base, dst_lstride, dst_pstride;
+	uintptr_t src_base, src_lstride, src_pstride;
+	size_t bytes, lines, planes;
+	bool nontemporal;
+	int split_dim;  // 0 = bytes, 1 = lines, 2 = planes
+	size_t split_count, piece_size, num_pieces;
+	atomic<size_t> next_piece;
+	int active_helpers;  // protected by the channel's split_mutex
+      };
+
+      MemcpySplitJob::MemcpySplitJob(uintptr_t _dst_base, uintptr_t _dst_lstride,
+				     uintptr_t _dst_pstride,
+				     uintptr_t _src_base, uintptr_t _src_lstride,
+				     uintptr_t _src_pstride,
+				     size_t _bytes, size_t _lines, size_t _planes,
+				     bool _nontemporal, size_t max_pieces)
+	: dst_base(_dst_base), dst_lstride(_dst_lstride)
+	, dst_pstride(_dst_pstride)
+	, src_base(_src_base), src_lstride(_src_lstride)
+	, src_pstride(_src_pstride)
+	, bytes(_bytes), lines(_lines), planes(_planes)
+	, nontemporal(_nontemporal)
+	, next_piece(0), active_helpers(0)
+      {
+	if(planes > 1) {
+	  split_dim = 2;
+	  split_count = planes;
+	  piece_size = (planes + max_pieces - 1) / max_pieces;
+	} else if(lines > 1) {
+	  split_dim = 1;
+	  split_count = lines;
+	  piece_size = (lines + max_pieces - 1) / max_pieces;
+	} else {
+	  split_dim = 0;
+	  split_count = bytes;
+	  // keep pieces on cache line boundaries so threads don't share
+	  //  destination lines
+	  piece_size = (((bytes + max_pieces - 1) / max_pieces) + 63) & ~size_t(63);
+	}
+	num_pieces = (split_count + piece_size - 1) / piece_size;
+      }
+
+      bool MemcpySplitJob::do_one_piece(void)
+      {
+	size_t idx = next_piece.fetch_add(1);
+	if(idx >= num_pieces)
+	  return false;
+
+	size_t lo = idx * piece_size;
+	size_t count = std::min(piece_size, split_count - lo);
+	switch(split_dim) {
+	case 2:
+	  memcpy_3d(dst_base + (lo * dst_pstride), dst_lstride, dst_pstride,
+		    src_base + (lo * src_pstride), src_lstride, src_pstride,
+		    bytes, lines, count, nontemporal);
+	  break;
+	case 1:
+	  memcpy_2d(dst_base + (lo * dst_lstride), dst_lstride,
+		    src_base + (lo * src_lstride), src_lstride,
+		    bytes, count, nontemporal);
+	  break;
+	default:
+	  memcpy_1d(dst_base + lo, src_base + lo, count, nontemporal);
+	  break;
+	}
+	return true;
+      }
+
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class MemcpySplitHelper
+  //
+
+      class MemcpySplitHelper : public BackgroundWorkItem {
+      public:
+	MemcpySplitHelper(MemcpyChannel *_channel);
+
+	void request_help(void);
+
+	virtual bool do_work(TimeLimit work_until);
+
+      protected:
+	MemcpyChannel *channel;
+	atomic<bool> requested;
+      };
+
+      MemcpySplitHelper::MemcpySplitHelper(MemcpyChannel *_channel)
+	: BackgroundWorkItem("memcpy split helper")
+	, channel(_channel)
+	, requested(false)
+      {}
+
+      void MemcpySplitHelper::request_help(void)
+      {
+	// only activate if we aren't already queued up
+	if(!requested.exchange(true))
+	  make_active();
+      }
+
+      bool MemcpySplitHelper::do_work(TimeLimit work_until)
+      {
+	// clear the flag first so that a new job posted while we're working
+	//  reactivates us
+	requested.store_release(false);
+	channel->help_with_split_copy();
+	return false;
+      }
+
+
   ////////////////////////////////////////////////////////////////////////
   //
   // class MemcpyChannel
@@ -5143,6 +5610,9 @@ namespace Realm {
 	: SingleXDQChannel<MemcpyChannel,MemcpyXferDes>(bgwork,
 							XFER_MEM_CPY,
 							"memcpy channel")
+	, split_job(0)
+	, split_done(split_mutex)
+	, split_bytes_per_us(0)
       {
         //cbs = (MemcpyRequest**) calloc(max_nr, sizeof(MemcpyRequest*));
 	unsigned bw = 5000; // HACK - estimate at 5 GB/s
@@ -5159,11 +5629,191 @@ namespace Realm {
           .allow_serdez();
 
 	xdq.add_to_manager(bgwork);
+
+	for(int i = 0; i < Config::memcpy_split_helpers; i++) {
+	  MemcpySplitHelper *helper = new MemcpySplitHelper(this);
+	  helper->add_to_manager(bgwork);
+	  split_helpers.push_back(helper);
+	}
+	// until we've measured a split copy, assume ~1 GB/s per thread,
+	//  which is pessimistic enough to not blow through time slices
+	split_bytes_per_us.store(1000 * (split_helpers.size() + 1));
+
+	// an extra queue for each numa domain that has a local memory
+	Node& n = get_runtime()->nodes[Network::my_node_id];
+	if(Config::memcpy_numa_queues) {
+	  for(std::vector<MemoryImpl *>::const_iterator it = n.memories.begin();
+	      it != n.memories.end();
+	      ++it) {
+	    int domain = memory_numa_domain(*it);
+	    if((domain < 0) || (numa_xdqs.count(domain) > 0))
+	      continue;
+	    XDQueue<MemcpyChannel, MemcpyXferDes> *q =
+	      new XDQueue<MemcpyChannel, MemcpyXferDes>(this,
+							stringbuilder() << "memcpy channel (numa " << domain << ")",
+							is_ordered);
+	    q->add_to_manager(bgwork, domain);
+	    numa_xdqs[domain] = q;
+	  }
+	}
       }
 
       MemcpyChannel::~MemcpyChannel()
       {
         //free(cbs);
+	delete_container_contents(split_helpers);
+	delete_container_contents(numa_xdqs);
+      }
+
+      void MemcpyChannel::shutdown()
+      {
+	SingleXDQChannel<MemcpyChannel,MemcpyXferDes>::shutdown();
+#ifdef DEBUG_REALM
+	for(std::vector<MemcpySplitHelper *>::iterator it = split_helpers.begin();
+	    it != split_helpers.end();
+	    ++it)
+	  (*it)->shutdown_work_item();
+	for(std::map<int, XDQueue<MemcpyChannel, MemcpyXferDes> *>::iterator it = numa_xdqs.begin();
+	    it != numa_xdqs.end();
+	    ++it)
+	  it->second->shutdown_work_item();
+#endif
+      }
+
+      XDQueue<MemcpyChannel, MemcpyXferDes> *MemcpyChannel::select_xdq(MemcpyXferDes *xd)
+      {
+	if(numa_xdqs.empty() || (xd->numa_domain < 0))
+	  return &xdq;
+
+	std::map<int, XDQueue<MemcpyChannel, MemcpyXferDes> *>::const_iterator it = numa_xdqs.find(xd->numa_domain);
+	if(it != numa_xdqs.end())
+	  return it->second;
+	else
+	  return &xdq;
+      }
+
+      void MemcpyChannel::enqueue_ready_xd(XferDes *xd)
+      {
+	// xferDes_queue needs to know about this for guid->xd translation
+	if(xd->xferDes_queue->enqueue_xferDes_local(xd,
+						    false /*!add_to_queue*/))
+	{
+	  MemcpyXferDes *mxd = checked_cast<MemcpyXferDes *>(xd);
+	  select_xdq(mxd)->enqueue_xd(mxd);
+	}
+      }
+
+      void MemcpyChannel::wakeup_xd(XferDes *xd)
+      {
+	// add this back to the front of the same queue it came from
+	log_new_dma.info() << "xd woken: xd=" << xd
+			   << " id=" << std::hex << xd->guid << std::dec;
+	MemcpyXferDes *mxd = checked_cast<MemcpyXferDes *>(xd);
+	select_xdq(mxd)->enqueue_xd(mxd, true);
+      }
+
+      size_t MemcpyChannel::max_copy_chunk(TimeLimit work_until) const
+      {
+	size_t chunk = 256 << 10;
+	// with helpers, let big copies through whole so they can be split,
+	//  but only as big as we expect to finish in the time we have left
+	if(!split_helpers.empty() && (Config::memcpy_split_threshold > 0)) {
+	  size_t split_chunk = 4 * Config::memcpy_split_threshold;
+	  size_t rate = split_bytes_per_us.load();
+	  while((split_chunk > chunk) &&
+		work_until.will_expire((split_chunk * 1000) / rate))
+	    split_chunk >>= 1;
+	  chunk = std::max(chunk, split_chunk);
+	}
+	return chunk;
+      }
+
+      void MemcpyChannel::copy_block(uintptr_t dst_base, uintptr_t dst_lstride,
+				     uintptr_t dst_pstride,
+				     uintptr_t src_base, uintptr_t src_lstride,
+				     uintptr_t src_pstride,
+				     size_t bytes, size_t lines, size_t planes,
+				     bool nontemporal)
+      {
+	size_t total = bytes * lines * planes;
+	if(!split_helpers.empty() && (Config::memcpy_split_threshold > 0) &&
+	   (total >= Config::memcpy_split_threshold)) {
+	  // a few pieces per thread to even out load imbalance
+	  MemcpySplitJob job(dst_base, dst_lstride, dst_pstride,
+			     src_base, src_lstride, src_pstride,
+			     bytes, lines, planes, nontemporal,
+			     4 * (split_helpers.size() + 1));
+	  bool posted = false;
+	  if(job.num_pieces > 1) {
+	    // only one split copy at a time - if somebody else has one going,
+	    //  we just do ours alone
+	    AutoLock<> al(split_mutex);
+	    if(split_job == 0) {
+	      split_job = &job;
+	      posted = true;
+	    }
+	  }
+	  if(posted) {
+	    long long t_start = Clock::current_time_in_nanoseconds();
+
+	    for(std::vector<MemcpySplitHelper *>::iterator it = split_helpers.begin();
+		it != split_helpers.end();
+		++it)
+	      (*it)->request_help();
+
+	    // work on pieces ourselves - if no helpers show up, we do it all
+	    while(job.do_one_piece()) {}
+
+	    // unpost the job so no new helpers join, and then sleep until any
+	    //  still working on their last piece are done
+	    {
+	      AutoLock<> al(split_mutex);
+	      split_job = 0;
+	      while(job.active_helpers > 0)
+		split_done.wait();
+	    }
+
+	    // update the throughput estimate used to size future chunks
+	    long long elapsed = Clock::current_time_in_nanoseconds() - t_start;
+	    if(elapsed > 0) {
+	      size_t rate = std::max(size_t(1), size_t((total * 1000) / elapsed));
+	      split_bytes_per_us.store((3 * split_bytes_per_us.load() + rate) / 4);
+	    }
+	    return;
+	  }
+	}
+
+	if(planes > 1)
+	  memcpy_3d(dst_base, dst_lstride, dst_pstride,
+		    src_base, src_lstride, src_pstride,
+		    bytes, lines, planes, nontemporal);
+	else if(lines > 1)
+	  memcpy_2d(dst_base, dst_lstride, src_base, src_lstride,
+		    bytes, lines, nontemporal);
+	else
+	  memcpy_1d(dst_base, src_base, bytes, nontemporal);
+      }
+
+      void MemcpyChannel::help_with_split_copy(void)
+      {
+	MemcpySplitJob *job;
+	{
+	  AutoLock<> al(split_mutex);
+	  job = split_job;
+	  if(job == 0)
+	    return;
+	  job->active_helpers++;
+	}
+
+	while(job->do_one_piece()) {}
+
+	// streaming stores are fenced at the end of each piece, so everything
+	//  we wrote is visible once the poster sees this
+	{
+	  AutoLock<> al(split_mutex);
+	  if(--job->active_helpers == 0)
+	    split_done.broadcast();
+	}
       }
 
       /*static*/ void MemcpyChannel::enumerate_local_cpu_memories(std::vector<Memory>& mems)
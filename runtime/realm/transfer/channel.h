@@ -224,7 +224,19 @@ namespace Realm {
       void advance(int dim, size_t amount);
 
       void skip_bytes(size_t bytes);
-      
+
+      // for channels that want to handle several entries at once (e.g. one
+      //  per field) - peeks at up to 'max_entries' whole entries starting
+      //  with the current one, returning how many were found (always 0 if
+      //  the current entry has been partially consumed)
+      // each entry is { (contig_bytes << 4) + dim, offset, count1, stride1,
+      //  count2, stride2, ... }
+      int peek_entries(const size_t **entries, int max_entries) const;
+
+      // consumes the whole current entry, which must not have been partially
+      //  consumed
+      void skip_entry();
+
     protected:
       AddressList *addrlist;
       bool partial;
@@ -553,6 +565,10 @@ namespace Realm {
 
       bool progress_xd(MemcpyChannel *channel, TimeLimit work_until);
 
+      // numa domain of the destination memory (or the source, if the
+      //  destination has none), or -1 - decided once when the xd is created
+      int numa_domain;
+
     private:
       bool memcpy_req_in_use;
       MemcpyRequest memcpy_req;
@@ -1030,6 +1046,9 @@ namespace Realm {
       XDQueue<CHANNEL, XD> xdq;
     };
 
+    struct MemcpySplitJob;
+    class MemcpySplitHelper;
+
     class MemcpyChannel : public SingleXDQChannel<MemcpyChannel, MemcpyXferDes> {
     public:
       MemcpyChannel(BackgroundWorkManager *bgwork);
@@ -1066,7 +1085,48 @@ namespace Realm {
 
       virtual long submit(Request** requests, long nr);
 
+      virtual void shutdown();
+
+      // xds are sent to the queue for the numa domain of their memories,
+      //  if there is one
+      virtual void enqueue_ready_xd(XferDes *xd);
+      virtual void wakeup_xd(XferDes *xd);
+
+      // copies an (up to) 3-D block, splitting large copies with the helper
+      //  work items if there are any - unused strides may be 0
+      void copy_block(uintptr_t dst_base, uintptr_t dst_lstride,
+		      uintptr_t dst_pstride,
+		      uintptr_t src_base, uintptr_t src_lstride,
+		      uintptr_t src_pstride,
+		      size_t bytes, size_t lines, size_t planes,
+		      bool nontemporal);
+
+      // largest copy an xd should hand to 'copy_block' at once, given the
+      //  time it has left
+      size_t max_copy_chunk(TimeLimit work_until) const;
+
       bool is_stopped;
+
+    protected:
+      friend class MemcpySplitHelper;
+
+      // called by a helper to work on the current split copy (if any)
+      void help_with_split_copy(void);
+
+      Mutex split_mutex;
+      MemcpySplitJob *split_job;  // protected by split_mutex
+      Mutex::CondVar split_done;  // signalled when a job's helpers are done
+      std::vector<MemcpySplitHelper *> split_helpers;
+      // measured throughput of split copies, used to keep chunks within
+      //  the xd's time slice
+      atomic<size_t> split_bytes_per_us;
+
+      // picks the queue for an xd - numa-specific bgwork workers favor work
+      //  from their own domain, so copies to/from numa-local memory tend
+      //  to be performed by cores on the same socket
+      XDQueue<MemcpyChannel, MemcpyXferDes> *select_xdq(MemcpyXferDes *xd);
+
+      std::map<int, XDQueue<MemcpyChannel, MemcpyXferDes> *> numa_xdqs;
     };
 
     class MemfillChannel : public SingleXDQChannel<MemfillChannel, MemfillXferDes> {
@@ -309,6 +309,8 @@ namespace Realm {
             assert(0);
         }
       }
+      // hand the whole batch to the kernel at once
+      aio_ctx->flush_submissions();
       return nr;
     }
 
@@ -377,6 +379,8 @@ namespace Realm {
             assert(0);
         }
       }
+      // hand the whole batch to the kernel at once
+      aio_ctx->flush_submissions();
       return nr;
     }
 
@@ -34,6 +34,17 @@
 #ifdef REALM_USE_LIBAIO
 #include <aio.h>
 #endif
+#ifdef REALM_USE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+// older C libraries may not know the syscall numbers even if the kernel
+//  headers are present
+#ifndef __NR_io_uring_setup
+#undef REALM_USE_IO_URING
+#endif
+#endif
 
 #include <queue>
 #include <algorithm>
@@ -60,6 +71,11 @@ namespace Realm {
 
     static AsyncFileIOContext *aio_context = 0;
 
+    namespace Config {
+      bool use_io_uring = false;
+      size_t io_uring_max_registered = 0;
+    };
+
 #ifdef REALM_USE_KERNEL_AIO
     inline int io_setup(unsigned nr, aio_context_t *ctxp)
     {
@@ -261,6 +277,359 @@ namespace Realm {
     }
 #endif
 
+#ifdef REALM_USE_IO_URING
+    inline int io_uring_setup(unsigned entries, struct io_uring_params *p)
+    {
+      return syscall(__NR_io_uring_setup, entries, p);
+    }
+
+    inline int io_uring_enter(int fd, unsigned to_submit,
+			      unsigned min_complete, unsigned flags)
+    {
+      return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+		     NULL, 0);
+    }
+
+    inline int io_uring_register(int fd, unsigned opcode,
+				 const void *arg, unsigned nr_args)
+    {
+      return syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+    }
+
+    // a minimal io_uring wrapper (talks to the kernel directly rather than
+    //  requiring liburing) - all methods are called with the
+    //  AsyncFileIOContext's mutex held, so the only concurrency to worry
+    //  about is with the kernel side of the rings
+    class IOUringContext {
+    public:
+      IOUringContext(void);
+      ~IOUringContext(void);
+
+      // returns false if the kernel doesn't support io_uring (or we're
+      //  not allowed to use it)
+      bool init(unsigned entries);
+
+      void register_buffers(const std::vector<std::pair<void *, size_t> >& ranges);
+
+      void queue_rw(bool is_write, int fd, size_t offset, size_t bytes,
+		    void *buffer, struct iovec *iov, void *user_data);
+
+      // submits any queued requests
+      void flush(void);
+
+      // marks completed operations, returns the number reaped
+      unsigned reap_completions(void);
+
+    protected:
+      int find_fixed_buffer(const void *buffer, size_t bytes) const;
+
+      int ring_fd;
+      void *sq_ring, *cq_ring;
+      size_t sq_ring_size, cq_ring_size;
+      struct io_uring_sqe *sqes;
+      size_t sqes_size;
+      unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+      unsigned *cq_head, *cq_tail, *cq_mask;
+      struct io_uring_cqe *cqes;
+      unsigned sq_entries;
+      unsigned local_sq_tail, unsubmitted;
+      // registered buffers, sorted by base address
+      std::vector<std::pair<uintptr_t, size_t> > fixed_buffers;
+    };
+
+    class IOUringOperation : public AsyncFileIOContext::AIOOperation {
+    public:
+      IOUringOperation(IOUringContext *_ring, bool _is_write,
+		       int _fd, size_t _offset, size_t _bytes,
+		       void *_buffer, Request* request = NULL);
+      virtual void launch(void);
+      virtual bool check_completion(void);
+
+    public:
+      IOUringContext *ring;
+      bool is_write;
+      int fd;
+      size_t offset, bytes;
+      void *buffer;
+      struct iovec iov;  // must live until the kernel consumes the request
+      int result;
+    };
+
+    IOUringOperation::IOUringOperation(IOUringContext *_ring, bool _is_write,
+				       int _fd, size_t _offset, size_t _bytes,
+				       void *_buffer, Request* request)
+      : ring(_ring), is_write(_is_write)
+      , fd(_fd), offset(_offset), bytes(_bytes), buffer(_buffer)
+      , result(0)
+    {
+      completed = false;
+      req = request;
+    }
+
+    void IOUringOperation::launch(void)
+    {
+      log_aio.debug("%s queued: op=%p", (is_write ? "write" : "read"), this);
+      ring->queue_rw(is_write, fd, offset, bytes, buffer, &iov, this);
+    }
+
+    bool IOUringOperation::check_completion(void)
+    {
+      if(!completed) return false;
+      log_aio.debug("%s returned: op=%p ret=%d",
+		    (is_write ? "write" : "read"), this, result);
+      if(result < 0) {
+	log_aio.fatal() << "io_uring " << (is_write ? "write" : "read")
+			<< " failed: fd=" << fd << " offset=" << offset
+			<< " bytes=" << bytes << " error=" << strerror(-result);
+	abort();
+      }
+      if(size_t(result) < bytes) {
+	// a read that makes no progress has hit the end of the file, which
+	//  means the file is shorter than the instance says it is
+	if(result == 0) {
+	  log_aio.fatal() << "io_uring " << (is_write ? "write" : "read")
+			  << " made no progress: fd=" << fd << " offset=" << offset
+			  << " bytes=" << bytes;
+	  abort();
+	}
+	// short read/write - resubmit the rest (the caller flushes the ring
+	//  after checking completions)
+	log_aio.debug() << "io_uring short " << (is_write ? "write" : "read")
+			<< ": op=" << this << " done=" << result << " of " << bytes;
+	offset += result;
+	bytes -= result;
+	buffer = static_cast<char *>(buffer) + result;
+	completed = false;
+	launch();
+	return false;
+      }
+      return true;
+    }
+
+    IOUringContext::IOUringContext(void)
+      : ring_fd(-1)
+      , sq_ring(MAP_FAILED), cq_ring(MAP_FAILED)
+      , sq_ring_size(0), cq_ring_size(0)
+      , sqes((struct io_uring_sqe *)MAP_FAILED), sqes_size(0)
+      , sq_entries(0), local_sq_tail(0), unsubmitted(0)
+    {}
+
+    IOUringContext::~IOUringContext(void)
+    {
+      assert(unsubmitted == 0);
+      if(sqes != MAP_FAILED)
+	munmap(sqes, sqes_size);
+      if((cq_ring != MAP_FAILED) && (cq_ring != sq_ring))
+	munmap(cq_ring, cq_ring_size);
+      if(sq_ring != MAP_FAILED)
+	munmap(sq_ring, sq_ring_size);
+      if(ring_fd >= 0)
+	close(ring_fd);
+    }
+
+    bool IOUringContext::init(unsigned entries)
+    {
+      struct io_uring_params p;
+      memset(&p, 0, sizeof(p));
+      ring_fd = io_uring_setup(entries, &p);
+      if(ring_fd < 0) {
+	log_aio.info() << "io_uring_setup failed: " << strerror(errno);
+	return false;
+      }
+
+      sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+      cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+      bool single_mmap = ((p.features & IORING_FEAT_SINGLE_MMAP) != 0);
+      if(single_mmap)
+	sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+
+      sq_ring = mmap(0, sq_ring_size, PROT_READ | PROT_WRITE,
+		     MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+      if(sq_ring == MAP_FAILED) {
+	log_aio.info() << "io_uring sq ring mmap failed: " << strerror(errno);
+	return false;
+      }
+      if(single_mmap) {
+	cq_ring = sq_ring;
+      } else {
+	cq_ring = mmap(0, cq_ring_size, PROT_READ | PROT_WRITE,
+		       MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+	if(cq_ring == MAP_FAILED) {
+	  log_aio.info() << "io_uring cq ring mmap failed: " << strerror(errno);
+	  return false;
+	}
+      }
+      sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+      sqes = (struct io_uring_sqe *)mmap(0, sqes_size, PROT_READ | PROT_WRITE,
+					 MAP_SHARED | MAP_POPULATE, ring_fd,
+					 IORING_OFF_SQES);
+      if(sqes == MAP_FAILED) {
+	log_aio.info() << "io_uring sqe mmap failed: " << strerror(errno);
+	return false;
+      }
+
+      char *sq_base = static_cast<char *>(sq_ring);
+      sq_head = reinterpret_cast<unsigned *>(sq_base + p.sq_off.head);
+      sq_tail = reinterpret_cast<unsigned *>(sq_base + p.sq_off.tail);
+      sq_mask = reinterpret_cast<unsigned *>(sq_base + p.sq_off.ring_mask);
+      sq_array = reinterpret_cast<unsigned *>(sq_base + p.sq_off.array);
+      char *cq_base = static_cast<char *>(cq_ring);
+      cq_head = reinterpret_cast<unsigned *>(cq_base + p.cq_off.head);
+      cq_tail = reinterpret_cast<unsigned *>(cq_base + p.cq_off.tail);
+      cq_mask = reinterpret_cast<unsigned *>(cq_base + p.cq_off.ring_mask);
+      cqes = reinterpret_cast<struct io_uring_cqe *>(cq_base + p.cq_off.cqes);
+
+      sq_entries = p.sq_entries;
+      local_sq_tail = *sq_tail;
+      log_aio.info() << "io_uring backend enabled: entries=" << sq_entries;
+      return true;
+    }
+
+    void IOUringContext::register_buffers(const std::vector<std::pair<void *, size_t> >& ranges)
+    {
+      // the kernel limits each registered buffer to 1GB, so larger ranges
+      //  are registered in pieces
+      const size_t max_chunk = size_t(1) << 30;
+      const size_t max_buffers = 1024;  // UIO_MAXIOV
+      std::vector<std::pair<uintptr_t, size_t> > chunks;
+      for(std::vector<std::pair<void *, size_t> >::const_iterator it = ranges.begin();
+	  it != ranges.end();
+	  ++it) {
+	// ranges are registered all or nothing - a partially registered
+	//  range would only help the requests that happen to land in it
+	size_t needed = (it->second + max_chunk - 1) / max_chunk;
+	if((chunks.size() + needed) > max_buffers) {
+	  log_aio.warning() << "io_uring: too many buffers to register - "
+			    << it->second << " bytes at " << it->first
+			    << " will use unregistered I/O";
+	  continue;
+	}
+	uintptr_t base = reinterpret_cast<uintptr_t>(it->first);
+	size_t left = it->second;
+	while(left > 0) {
+	  size_t chunk = std::min(left, max_chunk);
+	  chunks.push_back(std::make_pair(base, chunk));
+	  base += chunk;
+	  left -= chunk;
+	}
+      }
+      if(chunks.empty())
+	return;
+      std::sort(chunks.begin(), chunks.end());
+
+      std::vector<struct iovec> iovs(chunks.size());
+      for(size_t i = 0; i < chunks.size(); i++) {
+	iovs[i].iov_base = reinterpret_cast<void *>(chunks[i].first);
+	iovs[i].iov_len = chunks[i].second;
+      }
+      int ret = io_uring_register(ring_fd, IORING_REGISTER_BUFFERS,
+				  &iovs[0], iovs.size());
+      if(ret < 0) {
+	// most likely RLIMIT_MEMLOCK - everything still works, just without
+	//  the fixed buffer fast path
+	log_aio.warning() << "io_uring buffer registration failed (" << strerror(errno)
+			  << ") - using unregistered I/O";
+	return;
+      }
+      fixed_buffers.swap(chunks);
+      log_aio.info() << "io_uring registered " << fixed_buffers.size() << " buffers";
+    }
+
+    int IOUringContext::find_fixed_buffer(const void *buffer, size_t bytes) const
+    {
+      if(fixed_buffers.empty())
+	return -1;
+      uintptr_t ptr = reinterpret_cast<uintptr_t>(buffer);
+      // find the last buffer starting at or before 'ptr'
+      std::vector<std::pair<uintptr_t, size_t> >::const_iterator it =
+	std::upper_bound(fixed_buffers.begin(), fixed_buffers.end(),
+			 std::make_pair(ptr, ~size_t(0)));
+      if(it == fixed_buffers.begin())
+	return -1;
+      --it;
+      if((ptr + bytes) > (it->first + it->second))
+	return -1;
+      return (it - fixed_buffers.begin());
+    }
+
+    void IOUringContext::queue_rw(bool is_write, int fd, size_t offset,
+				  size_t bytes, void *buffer,
+				  struct iovec *iov, void *user_data)
+    {
+      // the AsyncFileIOContext never launches more than 'entries' ops, so
+      //  there's always room in the submission queue
+      unsigned head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+      assert((local_sq_tail - head) < sq_entries);
+      unsigned index = local_sq_tail & *sq_mask;
+      struct io_uring_sqe *sqe = &sqes[index];
+      memset(sqe, 0, sizeof(*sqe));
+      sqe->fd = fd;
+      sqe->off = offset;
+      sqe->user_data = reinterpret_cast<uintptr_t>(user_data);
+
+      int buf_index = find_fixed_buffer(buffer, bytes);
+      if(buf_index >= 0) {
+	sqe->opcode = (is_write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED);
+	sqe->addr = reinterpret_cast<uintptr_t>(buffer);
+	sqe->len = bytes;
+	sqe->buf_index = buf_index;
+      } else {
+	// READV/WRITEV rather than READ/WRITE to work on older kernels
+	iov->iov_base = buffer;
+	iov->iov_len = bytes;
+	sqe->opcode = (is_write ? IORING_OP_WRITEV : IORING_OP_READV);
+	sqe->addr = reinterpret_cast<uintptr_t>(iov);
+	sqe->len = 1;
+      }
+
+      sq_array[index] = index;
+      local_sq_tail++;
+      unsubmitted++;
+    }
+
+    void IOUringContext::flush(void)
+    {
+      if(unsubmitted == 0)
+	return;
+      // publish all the new entries at once and submit them with one syscall
+      __atomic_store_n(sq_tail, local_sq_tail, __ATOMIC_RELEASE);
+      while(unsubmitted > 0) {
+	int ret = io_uring_enter(ring_fd, unsubmitted, 0, 0);
+	if(ret < 0) {
+	  if((errno == EINTR) || (errno == EAGAIN) || (errno == EBUSY)) {
+	    // transient - try again on the next call
+	    log_aio.debug() << "io_uring_enter deferred: " << strerror(errno);
+	    return;
+	  }
+	  log_aio.fatal() << "io_uring_enter failed: " << strerror(errno);
+	  abort();
+	}
+	log_aio.debug() << "io_uring_enter submitted " << ret << " of " << unsubmitted;
+	unsubmitted -= ret;
+      }
+    }
+
+    unsigned IOUringContext::reap_completions(void)
+    {
+      unsigned head = *cq_head;
+      unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+      unsigned count = 0;
+      while(head != tail) {
+	struct io_uring_cqe *cqe = &cqes[head & *cq_mask];
+	IOUringOperation *op = reinterpret_cast<IOUringOperation *>(cqe->user_data);
+	op->result = cqe->res;
+	op->completed = true;
+	head++;
+	count++;
+      }
+      if(count > 0) {
+	__atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+	log_aio.debug() << "io_uring reaped " << count << " completions";
+      }
+      return count;
+    }
+#endif
+
     class AIOFence : public Operation::AsyncWorkItem {
     public:
       AIOFence(Operation *_op) : Operation::AsyncWorkItem(_op) {}
@@ -304,6 +673,7 @@ namespace Realm {
     AsyncFileIOContext::AsyncFileIOContext(int _max_depth)
       : BackgroundWorkItem("async file IO")
       , max_depth(_max_depth)
+      , uring(0)
     {
 #ifdef REALM_USE_KERNEL_AIO
       aio_ctx = 0;
@@ -313,6 +683,18 @@ namespace Realm {
 	io_setup(max_depth, &aio_ctx);
       assert(ret == 0);
 #endif
+      if(Config::use_io_uring) {
+#ifdef REALM_USE_IO_URING
+	uring = new IOUringContext;
+	if(!uring->init(max_depth)) {
+	  log_aio.warning() << "io_uring not available - falling back to default async file I/O";
+	  delete uring;
+	  uring = 0;
+	}
+#else
+	log_aio.warning() << "io_uring support not compiled in - using default async file I/O";
+#endif
+      }
     }
 
     AsyncFileIOContext::~AsyncFileIOContext(void)
@@ -325,6 +707,9 @@ namespace Realm {
 #endif
 	io_destroy(aio_ctx);
       assert(ret == 0);
+#endif
+#ifdef REALM_USE_IO_URING
+      delete uring;
 #endif
     }
 
@@ -332,15 +717,23 @@ namespace Realm {
 					   size_t bytes, const void *buffer,
                                            Request* req)
     {
+      AsyncFileIOContext::AIOOperation* op = 0;
+#ifdef REALM_USE_IO_URING
+      if(uring)
+	op = new IOUringOperation(uring, true /*is_write*/,
+				  fd, offset, bytes, const_cast<void *>(buffer),
+				  req);
+      else
+#endif
+      {
 #ifdef REALM_USE_KERNEL_AIO
-      KernelAIOWrite *op = new KernelAIOWrite(aio_ctx,
-					      fd, offset, bytes, buffer, req);
+	op = new KernelAIOWrite(aio_ctx, fd, offset, bytes, buffer, req);
 #elif defined(REALM_USE_LIBAIO)
-      PosixAIOWrite *op = new PosixAIOWrite(fd, offset, bytes, buffer, req);
+	op = new PosixAIOWrite(fd, offset, bytes, buffer, req);
 #else
-      AsyncFileIOContext::AIOOperation* op = 0;
-      assert(0);
+	assert(0);
 #endif
+      }
       bool was_empty;
       {
 	AutoLock<> al(mutex);
@@ -360,15 +753,22 @@ namespace Realm {
 					  size_t bytes, void *buffer,
                                           Request* req)
     {
+      AsyncFileIOContext::AIOOperation* op = 0;
+#ifdef REALM_USE_IO_URING
+      if(uring)
+	op = new IOUringOperation(uring, false /*!is_write*/,
+				  fd, offset, bytes, buffer, req);
+      else
+#endif
+      {
 #ifdef REALM_USE_KERNEL_AIO
-      KernelAIORead *op = new KernelAIORead(aio_ctx,
-					    fd, offset, bytes, buffer, req);
+	op = new KernelAIORead(aio_ctx, fd, offset, bytes, buffer, req);
 #elif defined(REALM_USE_LIBAIO)
-      PosixAIORead *op = new PosixAIORead(fd, offset, bytes, buffer, req);
+	op = new PosixAIORead(fd, offset, bytes, buffer, req);
 #else
-      AsyncFileIOContext::AIOOperation* op = 0;
-      assert(0);
+	assert(0);
 #endif
+      }
       bool was_empty;
       {
 	AutoLock<> al(mutex);
@@ -402,6 +802,26 @@ namespace Realm {
 	make_active();
     }
 
+    void AsyncFileIOContext::flush_submissions(void)
+    {
+#ifdef REALM_USE_IO_URING
+      if(uring) {
+	AutoLock<> al(mutex);
+	uring->flush();
+      }
+#endif
+    }
+
+    void AsyncFileIOContext::register_buffers(const std::vector<std::pair<void *, size_t> >& ranges)
+    {
+#ifdef REALM_USE_IO_URING
+      if(uring) {
+	AutoLock<> al(mutex);
+	uring->register_buffers(ranges);
+      }
+#endif
+    }
+
     bool AsyncFileIOContext::empty(void)
     {
       AutoLock<> al(mutex);
@@ -435,6 +855,12 @@ namespace Realm {
 	}
       }
 #endif
+#ifdef REALM_USE_IO_URING
+      if(uring) {
+	uring->flush();
+	uring->reap_completions();
+      }
+#endif
 
       // now actually mark events completed in oldest-first order
       while(!launched_operations.empty()) {
@@ -460,6 +886,10 @@ namespace Realm {
 	op->launch();
 	launched_operations.push_back(op);
       }
+#ifdef REALM_USE_IO_URING
+      if(uring)
+	uring->flush();
+#endif
     }
 
     bool AsyncFileIOContext::do_work(TimeLimit work_until)
@@ -491,6 +921,15 @@ namespace Realm {
       {
 	AutoLock<> al(mutex);
 
+#ifdef REALM_USE_IO_URING
+	// submit anything that's been queued since the last flush and pick up
+	//  completions - the bgwork thread is the only one polling the ring
+	if(uring) {
+	  uring->flush();
+	  uring->reap_completions();
+	}
+#endif
+
 	// now actually mark events completed in oldest-first order
 	while(!work_until.is_expired()) {
 	  AIOOperation *op = launched_operations.front();
@@ -526,6 +965,10 @@ namespace Realm {
 	  op->launch();
 	  launched_operations.push_back(op);
 	}
+#ifdef REALM_USE_IO_URING
+	if(uring)
+	  uring->flush();
+#endif
       }
 
       // if we fall through to here, there's still polling for either old
@@ -828,6 +1271,38 @@ namespace Realm {
     {
       aio_context = new AsyncFileIOContext(256);
       aio_context->add_to_manager(bgwork);
+
+      // registering memory as io_uring fixed buffers pins it, so it's only
+      //  done when asked for, and only for memories that fit (whole) in the
+      //  requested budget - local cpu memories are the only things the
+      //  disk/file channels transfer to/from
+      if(Config::use_io_uring && (Config::io_uring_max_registered > 0)) {
+	std::vector<std::pair<void *, size_t> > io_ranges;
+	size_t budget = Config::io_uring_max_registered;
+	const Node& n = get_runtime()->nodes[Network::my_node_id];
+	for(std::vector<MemoryImpl *>::const_iterator it = n.memories.begin();
+	    it != n.memories.end();
+	    ++it) {
+	  if(((*it)->lowlevel_kind != Memory::SYSTEM_MEM) &&
+	     ((*it)->lowlevel_kind != Memory::REGDMA_MEM) &&
+	     ((*it)->lowlevel_kind != Memory::SOCKET_MEM))
+	    continue;
+	  if((*it)->size == 0)
+	    continue;
+	  if((*it)->size > budget) {
+	    log_aio.warning() << "io_uring: not registering " << (*it)->me
+			      << " (" << (*it)->size << " bytes) - only " << budget
+			      << " bytes left under -ll:io_uring_regmem";
+	    continue;
+	  }
+	  void *base = (*it)->get_direct_ptr(0, (*it)->size);
+	  if(!base)
+	    continue;
+	  io_ranges.push_back(std::make_pair(base, (*it)->size));
+	  budget -= (*it)->size;
+	}
+	aio_context->register_buffers(io_ranges);
+      }
     }
 
     void stop_dma_system(void)
@@ -32,6 +32,11 @@ namespace Realm {
     namespace Config {
       // the size of the LRU of the cache
       extern size_t path_cache_lru_size;
+      // use io_uring for disk/file channels if the kernel supports it
+      extern bool use_io_uring;
+      // upper bound on how much local memory may be registered (and thus
+      //  pinned) as io_uring fixed buffers - 0 disables registration
+      extern size_t io_uring_max_registered;
     };
 
     extern void init_dma_handler(void);
@@ -109,6 +114,8 @@ namespace Realm {
 			    MemPathInfo& info,
 			    bool skip_final_memcpy = false);
 
+    class IOUringContext;
+
     class AsyncFileIOContext : public BackgroundWorkItem {
     public:
       AsyncFileIOContext(int _max_depth);
@@ -118,6 +125,15 @@ namespace Realm {
       void enqueue_read(int fd, size_t offset, size_t bytes, void *buffer, Request* req = NULL);
       void enqueue_fence(Operation *req);
 
+      // hands any reads/writes enqueued since the last call to the kernel
+      //  in a single batch (no-op unless the io_uring backend is in use)
+      void flush_submissions(void);
+
+      // ranges of host memory that will be used as I/O buffers - the
+      //  io_uring backend registers these with the kernel so that transfers
+      //  to/from them don't have to map the pages on every request
+      void register_buffers(const std::vector<std::pair<void *, size_t> >& ranges);
+
       bool empty(void);
       long available(void);
 
@@ -143,6 +159,7 @@ namespace Realm {
 #ifdef REALM_USE_KERNEL_AIO
       aio_context_t aio_ctx;
 #endif
+      IOUringContext *uring;  // non-null iff the io_uring backend is in use
     };
 
   class WrappingFIFOIterator : public TransferIterator {
@@ -0,0 +1,260 @@
+/* Copyright 2023 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// vectorized CPU copy kernels used by the memcpy channel
+
+#include "realm/transfer/memcpy_kernels.h"
+
+#include "realm/atomics.h"
+
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+// the SIMD variants are compiled with per-function target attributes, so
+//  they're available even if the rest of Realm isn't built for those
+//  instruction sets, and are only used after checking the cpu at runtime
+#if defined(__x86_64__) && defined(__GNUC__)
+#define REALM_MEMCPY_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace Realm {
+
+  namespace Config {
+    size_t memcpy_nt_threshold = 4 << 20;
+    size_t memcpy_split_threshold = 4 << 20;
+    int memcpy_split_helpers = 0;
+    size_t memcpy_transpose_max = 64 << 20;
+    bool memcpy_numa_queues = true;
+  };
+
+  static atomic<int> selected_variant(MemcpyKernels::VARIANT_AUTO);
+
+#ifdef REALM_MEMCPY_X86_KERNELS
+  // each kernel does unaligned loads and aligned stores - a short head copy
+  //  aligns the destination, and the tail is handled by libc
+  __attribute__((target("sse2")))
+  static void copy_sse2(char *dst, const char *src, size_t bytes,
+			bool nontemporal)
+  {
+    size_t head = (-reinterpret_cast<uintptr_t>(dst)) & 15;
+    if(head > bytes) head = bytes;
+    memcpy(dst, src, head);
+    dst += head; src += head; bytes -= head;
+
+    if(nontemporal) {
+      for(; bytes >= 64; bytes -= 64, src += 64, dst += 64) {
+	__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+	__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16));
+	__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 32));
+	__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 48));
+	_mm_stream_si128(reinterpret_cast<__m128i *>(dst), a);
+	_mm_stream_si128(reinterpret_cast<__m128i *>(dst + 16), b);
+	_mm_stream_si128(reinterpret_cast<__m128i *>(dst + 32), c);
+	_mm_stream_si128(reinterpret_cast<__m128i *>(dst + 48), d);
+      }
+    } else {
+      for(; bytes >= 64; bytes -= 64, src += 64, dst += 64) {
+	__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+	__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16));
+	__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 32));
+	__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 48));
+	_mm_store_si128(reinterpret_cast<__m128i *>(dst), a);
+	_mm_store_si128(reinterpret_cast<__m128i *>(dst + 16), b);
+	_mm_store_si128(reinterpret_cast<__m128i *>(dst + 32), c);
+	_mm_store_si128(reinterpret_cast<__m128i *>(dst + 48), d);
+      }
+    }
+    memcpy(dst, src, bytes);
+  }
+
+  __attribute__((target("avx2")))
+  static void copy_avx2(char *dst, const char *src, size_t bytes,
+			bool nontemporal)
+  {
+    size_t head = (-reinterpret_cast<uintptr_t>(dst)) & 31;
+    if(head > bytes) head = bytes;
+    memcpy(dst, src, head);
+    dst += head; src += head; bytes -= head;
+
+    if(nontemporal) {
+      for(; bytes >= 128; bytes -= 128, src += 128, dst += 128) {
+	__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+	__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 32));
+	__m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 64));
+	__m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 96));
+	_mm256_stream_si256(reinterpret_cast<__m256i *>(dst), a);
+	_mm256_stream_si256(reinterpret_cast<__m256i *>(dst + 32), b);
+	_mm256_stream_si256(reinterpret_cast<__m256i *>(dst + 64), c);
+	_mm256_stream_si256(reinterpret_cast<__m256i *>(dst + 96), d);
+      }
+    } else {
+      for(; bytes >= 128; bytes -= 128, src += 128, dst += 128) {
+	__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+	__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 32));
+	__m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 64));
+	__m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 96));
+	_mm256_store_si256(reinterpret_cast<__m256i *>(dst), a);
+	_mm256_store_si256(reinterpret_cast<__m256i *>(dst + 32), b);
+	_mm256_store_si256(reinterpret_cast<__m256i *>(dst + 64), c);
+	_mm256_store_si256(reinterpret_cast<__m256i *>(dst + 96), d);
+      }
+    }
+    // avoid AVX-SSE transition penalties in whatever runs next
+    _mm256_zeroupper();
+    memcpy(dst, src, bytes);
+  }
+
+  __attribute__((target("avx512f")))
+  static void copy_avx512(char *dst, const char *src, size_t bytes,
+			  bool nontemporal)
+  {
+    size_t head = (-reinterpret_cast<uintptr_t>(dst)) & 63;
+    if(head > bytes) head = bytes;
+    memcpy(dst, src, head);
+    dst += head; src += head; bytes -= head;
+
+    if(nontemporal) {
+      for(; bytes >= 256; bytes -= 256, src += 256, dst += 256) {
+	__m512i a = _mm512_loadu_si512(src);
+	__m512i b = _mm512_loadu_si512(src + 64);
+	__m512i c = _mm512_loadu_si512(src + 128);
+	__m512i d = _mm512_loadu_si512(src + 192);
+	_mm512_stream_si512(reinterpret_cast<__m512i *>(dst), a);
+	_mm512_stream_si512(reinterpret_cast<__m512i *>(dst + 64), b);
+	_mm512_stream_si512(reinterpret_cast<__m512i *>(dst + 128), c);
+	_mm512_stream_si512(reinterpret_cast<__m512i *>(dst + 192), d);
+      }
+    } else {
+      for(; bytes >= 256; bytes -= 256, src += 256, dst += 256) {
+	__m512i a = _mm512_loadu_si512(src);
+	__m512i b = _mm512_loadu_si512(src + 64);
+	__m512i c = _mm512_loadu_si512(src + 128);
+	__m512i d = _mm512_loadu_si512(src + 192);
+	_mm512_store_si512(dst, a);
+	_mm512_store_si512(dst + 64, b);
+	_mm512_store_si512(dst + 128, c);
+	_mm512_store_si512(dst + 192, d);
+      }
+    }
+    _mm256_zeroupper();
+    memcpy(dst, src, bytes);
+  }
+#endif
+
+
+  ////////////////////////////////////////////////////////////////////////
+  //
+  // class MemcpyKernels
+  //
+
+  /*static*/ const char *MemcpyKernels::variant_name(Variant v)
+  {
+    switch(v) {
+    case VARIANT_AUTO: return "auto";
+    case VARIANT_SCALAR: return "scalar";
+    case VARIANT_SSE2: return "sse2";
+    case VARIANT_AVX2: return "avx2";
+    case VARIANT_AVX512: return "avx512";
+    default: return "unknown";
+    }
+  }
+
+  /*static*/ bool MemcpyKernels::parse_variant(const std::string& name,
+					       Variant& v)
+  {
+    for(int i = VARIANT_AUTO; i < NUM_VARIANTS; i++)
+      if(name == variant_name(static_cast<Variant>(i))) {
+	v = static_cast<Variant>(i);
+	return true;
+      }
+    return false;
+  }
+
+  /*static*/ bool MemcpyKernels::is_supported(Variant v)
+  {
+    switch(v) {
+    case VARIANT_AUTO:
+    case VARIANT_SCALAR:
+      return true;
+#ifdef REALM_MEMCPY_X86_KERNELS
+    // __builtin_cpu_supports also checks that the OS saves the wider
+    //  register state
+    case VARIANT_SSE2: return __builtin_cpu_supports("sse2");
+    case VARIANT_AVX2: return __builtin_cpu_supports("avx2");
+    case VARIANT_AVX512: return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+      return false;
+    }
+  }
+
+  /*static*/ MemcpyKernels::Variant MemcpyKernels::best_supported(void)
+  {
+    // cpu features don't change, so only check once
+    static Variant best = VARIANT_AUTO;
+    if(best == VARIANT_AUTO) {
+      Variant v = static_cast<Variant>(NUM_VARIANTS - 1);
+      while((v > VARIANT_SCALAR) && !is_supported(v))
+	v = static_cast<Variant>(v - 1);
+      best = v;
+    }
+    return best;
+  }
+
+  /*static*/ MemcpyKernels::Variant MemcpyKernels::get_selected(void)
+  {
+    return static_cast<Variant>(selected_variant.load());
+  }
+
+  /*static*/ void MemcpyKernels::set_selected(Variant v)
+  {
+    assert(is_supported(v));
+    selected_variant.store(v);
+  }
+
+  /*static*/ void MemcpyKernels::copy(Variant v, void *dst, const void *src,
+				      size_t bytes, bool nontemporal)
+  {
+    switch(v) {
+#ifdef REALM_MEMCPY_X86_KERNELS
+    case VARIANT_SSE2:
+      copy_sse2(static_cast<char *>(dst), static_cast<const char *>(src),
+		bytes, nontemporal);
+      break;
+    case VARIANT_AVX2:
+      copy_avx2(static_cast<char *>(dst), static_cast<const char *>(src),
+		bytes, nontemporal);
+      break;
+    case VARIANT_AVX512:
+      copy_avx512(static_cast<char *>(dst), static_cast<const char *>(src),
+		  bytes, nontemporal);
+      break;
+#endif
+    default:
+      memcpy(dst, src, bytes);
+      break;
+    }
+  }
+
+  /*static*/ void MemcpyKernels::store_fence(void)
+  {
+#ifdef REALM_MEMCPY_X86_KERNELS
+    _mm_sfence();
+#endif
+  }
+
+};
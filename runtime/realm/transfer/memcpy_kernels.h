@@ -0,0 +1,82 @@
+/* Copyright 2023 Stanford University, NVIDIA Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// vectorized CPU copy kernels used by the memcpy channel
+
+#ifndef REALM_MEMCPY_KERNELS_H
+#define REALM_MEMCPY_KERNELS_H
+
+#include "realm/realm_config.h"
+
+#include <stddef.h>
+#include <string>
+
+namespace Realm {
+
+  namespace Config {
+    // copies at least this large use non-temporal stores (0 = never)
+    extern size_t memcpy_nt_threshold;
+    // copies at least this large are split across helper work items
+    extern size_t memcpy_split_threshold;
+    // number of helper work items that may join a large copy (0 = none)
+    extern int memcpy_split_helpers;
+    // largest group of fields moved by a single transposing (e.g. AOS <->
+    //  SOA) copy (0 = disable transposing copies)
+    extern size_t memcpy_transpose_max;
+    // if true, memcpy copies are queued by the numa domain of their memories
+    //  so that numa-specific bgwork workers can favor local copies
+    extern bool memcpy_numa_queues;
+  };
+
+  class REALM_INTERNAL_API_EXTERNAL_LINKAGE MemcpyKernels {
+  public:
+    enum Variant {
+      // use the best supported variant for streaming (i.e. large) copies
+      //  and the compiler/libc copy for everything else
+      VARIANT_AUTO = -1,
+      VARIANT_SCALAR = 0,  // compiler/libc copy - no streaming stores
+      VARIANT_SSE2,
+      VARIANT_AVX2,
+      VARIANT_AVX512,
+      NUM_VARIANTS
+    };
+
+    static const char *variant_name(Variant v);
+
+    // parses a variant name (or "auto"), returns false if unknown
+    static bool parse_variant(const std::string& name, Variant& v);
+
+    // is the variant both compiled in and supported by this cpu?
+    static bool is_supported(Variant v);
+
+    static Variant best_supported(void);
+
+    // the variant the memcpy channel uses - defaults to VARIANT_AUTO, but
+    //  can be changed at any time (e.g. by benchmarks)
+    static Variant get_selected(void);
+    static void set_selected(Variant v);
+
+    // contiguous copy with a specific (supported) variant - 'nontemporal'
+    //  requests streaming stores, which are not ordered with respect to
+    //  other stores until 'store_fence' is called
+    static void copy(Variant v, void *dst, const void *src, size_t bytes,
+		     bool nontemporal);
+
+    static void store_fence(void);
+  };
+
+};
+
+#endif
@@ -967,6 +967,7 @@ REALM_SRC 	+= $(LG_RT_DIR)/realm/runtime_impl.cc \
 	           $(LG_RT_DIR)/realm/transfer/channel_disk.cc \
 	           $(LG_RT_DIR)/realm/transfer/lowlevel_dma.cc \
 	           $(LG_RT_DIR)/realm/transfer/ib_memory.cc \
+	           $(LG_RT_DIR)/realm/transfer/memcpy_kernels.cc \
 	           $(LG_RT_DIR)/realm/mutex.cc \
 	           $(LG_RT_DIR)/realm/module.cc \
 	           $(LG_RT_DIR)/realm/threads.cc \
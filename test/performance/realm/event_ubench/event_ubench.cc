@@ -28,14 +28,17 @@ enum
   BENCH_LAUNCHER_TASK = Processor::TASK_ID_FIRST_AVAILABLE + 0,
   BENCH_SETUP_FAN_TASK,
   BENCH_SETUP_CHAIN_TASK,
-  BENCH_TIMING_TASK
+  BENCH_TIMING_TASK,
+  BENCH_TRIGGER_TIMING_TASK,
+  BENCH_TRIGGER_WORKER_TASK
 };
 
 enum TestFlags
 {
   EVENT_TEST = 1 << 0,
   FAN_TEST = 1 << 1,
-  CHAIN_TEST = 1 << 2
+  CHAIN_TEST = 1 << 2,
+  TRIGGER_TEST = 1 << 3
 };
 
 struct BenchLauncherTaskArgs {
@@ -45,6 +48,7 @@ struct BenchLauncherTaskArgs {
   size_t num_samples = 0;
   size_t min_test_size = 1024;
   size_t max_test_size = 1024;
+  size_t max_threads = 64;
 };
 
 struct BenchSetupFanTaskArgs {
@@ -62,6 +66,19 @@ struct BenchSetupChainTaskArgs {
   UserEvent chain_events[1];
 };
 
+struct BenchTriggerWorkerTaskArgs {
+  size_t worker_idx;
+  size_t num_workers;
+  size_t num_events;
+  UserEvent shared_events[1];
+};
+
+struct BenchTriggerTimingTaskArgs {
+  size_t min_num_events;
+  size_t max_num_events;
+  size_t max_threads;
+};
+
 struct BenchTimingTaskArgs {
   uint64_t enabled_tests;
   bool measure_latency;
@@ -271,6 +288,72 @@ static void bench_setup_chain_task(const void *args, size_t arglen, const void *
   }
 }
 
+// TRIGGER: every worker adds a waiter to each of a shared set of events and
+// triggers its share of them (round-robin), so that waiter registration and
+// triggering on the same events race across all the worker threads.  Each
+// shared event accounts for one trigger plus one deferred trigger per worker.
+static void bench_trigger_worker_task(const void *args, size_t arglen,
+                                      const void *userdata, size_t userlen, Processor p)
+{
+  const BenchTriggerWorkerTaskArgs &src_args =
+      *static_cast<const BenchTriggerWorkerTaskArgs *>(args);
+  assert(arglen == sizeof(src_args) +
+                       (src_args.num_events - 1) * sizeof(src_args.shared_events[0]));
+  std::vector<Event> local_events(src_args.num_events, Event::NO_EVENT);
+  for(size_t i = 0; i < src_args.num_events; i++) {
+    UserEvent e = UserEvent::create_user_event();
+    e.trigger(src_args.shared_events[i]);
+    local_events[i] = e;
+    if((i % src_args.num_workers) == src_args.worker_idx)
+      src_args.shared_events[i].trigger();
+  }
+  Event::merge_events(local_events).wait();
+}
+
+static void bench_trigger_timing_task(const void *args, size_t arglen,
+                                      const void *userdata, size_t userlen, Processor p)
+{
+  assert(arglen == sizeof(BenchTriggerTimingTaskArgs));
+  const BenchTriggerTimingTaskArgs &src_args =
+      *static_cast<const BenchTriggerTimingTaskArgs *>(args);
+
+  std::vector<Processor> procs;
+  Machine::ProcessorQuery q =
+      Machine::ProcessorQuery(Machine::get_machine()).only_kind(Processor::LOC_PROC);
+  for(Processor p2 : q)
+    procs.push_back(p2);
+
+  for(size_t num_events = src_args.min_num_events; num_events <= src_args.max_num_events;
+      num_events <<= 1) {
+    for(size_t num_workers = 1;
+        (num_workers <= procs.size()) && (num_workers <= src_args.max_threads);
+        num_workers <<= 1) {
+      std::vector<char> task_arg_buffer(sizeof(BenchTriggerWorkerTaskArgs) +
+                                        (num_events - 1) * sizeof(UserEvent));
+      BenchTriggerWorkerTaskArgs &task_args =
+          *reinterpret_cast<BenchTriggerWorkerTaskArgs *>(task_arg_buffer.data());
+      task_args.num_workers = num_workers;
+      task_args.num_events = num_events;
+      for(size_t i = 0; i < num_events; i++)
+        task_args.shared_events[i] = UserEvent::create_user_event();
+
+      // hold all the workers until they've all been launched
+      UserEvent start_event = UserEvent::create_user_event();
+      std::vector<Event> worker_events(num_workers, Event::NO_EVENT);
+      for(size_t i = 0; i < num_workers; i++) {
+        task_args.worker_idx = i;
+        worker_events[i] = procs[i].spawn(BENCH_TRIGGER_WORKER_TASK, &task_args,
+                                          task_arg_buffer.size(), start_event);
+      }
+      Event wait_event = Event::merge_events(worker_events);
+
+      double usecs = time_dag(start_event, wait_event);
+      log_app.print() << "Trigger test " << num_workers << " threads";
+      report_timing(usecs, false /*!measure_latency*/, num_events, num_workers + 1);
+    }
+  }
+}
+
 // This task launches a task for each pair of processors in the machine.
 static void bench_launcher(const void *args, size_t arglen, const void *userdata,
                            size_t userlen, Processor p)
@@ -305,6 +388,14 @@ static void bench_launcher(const void *args, size_t arglen, const void *userdata
     }
   }
 
+  if(src_args.enabled_tests & TRIGGER_TEST) {
+    BenchTriggerTimingTaskArgs trigger_args;
+    trigger_args.min_num_events = src_args.min_test_size;
+    trigger_args.max_num_events = src_args.max_test_size;
+    trigger_args.max_threads = src_args.max_threads;
+    e = p.spawn(BENCH_TRIGGER_TIMING_TASK, &trigger_args, sizeof(trigger_args), e);
+  }
+
   Runtime::get_runtime().shutdown(e);
 }
 
@@ -320,6 +411,8 @@ int main(int argc, char **argv)
   r.register_task(BENCH_SETUP_FAN_TASK, bench_setup_fan_task);
   r.register_task(BENCH_SETUP_CHAIN_TASK, bench_setup_chain_task);
   r.register_task(BENCH_TIMING_TASK, bench_timing_task);
+  r.register_task(BENCH_TRIGGER_TIMING_TASK, bench_trigger_timing_task);
+  r.register_task(BENCH_TRIGGER_WORKER_TASK, bench_trigger_worker_task);
 
   BenchLauncherTaskArgs args;
   std::vector<std::string> enabled_tests;
@@ -330,6 +423,7 @@ int main(int argc, char **argv)
   cp.add_option_int("-m", args.min_test_size);
   cp.add_option_int("-n", args.max_test_size);
   cp.add_option_bool("-L", args.measure_latency);
+  cp.add_option_int("-threads", args.max_threads);
   ok = cp.parse_command_line(argc, (const char **)argv);
 
   if (args.min_test_size > args.max_test_size) {
@@ -346,6 +440,8 @@ int main(int argc, char **argv)
         args.enabled_tests |= (uint64_t)CHAIN_TEST;
       else if(enabled_tests[i] == "EVENT")
         args.enabled_tests |= (uint64_t)EVENT_TEST;
+      else if(enabled_tests[i] == "TRIGGER")
+        args.enabled_tests |= (uint64_t)TRIGGER_TEST;
       else
         abort();
     }
@@ -0,0 +1,282 @@
+#include "realm.h"
+#include "realm/activemsg.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include <unistd.h>
+
+#include "osdep.h"
+
+using namespace Realm;
+
+Logger log_app("app");
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+  SEND_TASK,
+  CHECK_TASK,
+};
+
+int num_batches = 100;
+int batch_length = 30;
+size_t max_batch_size = 0; // 0 = let ActiveMessageBatch choose
+int max_wait_seconds = 30;
+
+// every node sends the same sequence of messages to every node (itself
+//  included) - the receiver checks that each sender's messages arrive in
+//  exactly the order they were appended, whatever kind of handler they have
+Mutex seq_mutex;
+std::map<NodeID, int> next_seq;
+int order_errors = 0;
+int payload_errors = 0;
+
+static void record_message(NodeID sender, int seq,
+			   const void *payload, size_t payload_size)
+{
+  // message 'seq' carries (seq % 4) ints of payload
+  int count = seq % 4;
+  bool payload_ok = (payload_size == count * sizeof(int));
+  for(int i = 0; payload_ok && (i < count); i++) {
+    int v;
+    memcpy(&v, static_cast<const char *>(payload) + (i * sizeof(int)),
+	   sizeof(int));
+    payload_ok = (v == (seq + i));
+  }
+
+  AutoLock<> al(seq_mutex);
+  int& expected = next_seq[sender];
+  if(seq != expected) {
+    if(order_errors++ < 10)
+      log_app.error() << "out of order: sender=" << sender
+		      << " seq=" << seq << " expected=" << expected;
+  }
+  expected = seq + 1;
+  if(!payload_ok && (payload_errors++ < 10))
+    log_app.error() << "bad payload: sender=" << sender << " seq=" << seq;
+}
+
+// a handler with a time limit
+struct TimedMessage {
+  int seq;
+
+  static void handle_message(NodeID sender, const TimedMessage& msg,
+			     const void *data, size_t datalen,
+			     TimeLimit work_until)
+  {
+    record_message(sender, msg.seq, data, datalen);
+  }
+};
+
+ActiveMessageHandlerReg<TimedMessage> timed_message_handler;
+
+// a handler without a time limit
+struct PlainMessage {
+  int seq;
+
+  static void handle_message(NodeID sender, const PlainMessage& msg,
+			     const void *data, size_t datalen)
+  {
+    record_message(sender, msg.seq, data, datalen);
+  }
+};
+
+ActiveMessageHandlerReg<PlainMessage> plain_message_handler;
+
+// a handler with an inline variant - if one of these were handled inline
+//  ahead of the queued messages before it, it would show up as out of order
+struct InlineMessage {
+  int seq;
+
+  static void handle_message(NodeID sender, const InlineMessage& msg,
+			     const void *data, size_t datalen,
+			     TimeLimit work_until)
+  {
+    record_message(sender, msg.seq, data, datalen);
+  }
+
+  static bool handle_inline(NodeID sender, const InlineMessage& msg,
+			    const void *data, size_t datalen,
+			    TimeLimit work_until)
+  {
+    // must not block on a mutex in an inline handler
+    if(!seq_mutex.trylock())
+      return false;
+    seq_mutex.unlock();
+    record_message(sender, msg.seq, data, datalen);
+    return true;
+  }
+};
+
+ActiveMessageHandlerReg<InlineMessage> inline_message_handler;
+
+template <typename T>
+static void append_message(ActiveMessageBatch& batch, int seq)
+{
+  T msg;
+  msg.seq = seq;
+  int payload[3];
+  int count = seq % 4;
+  for(int i = 0; i < count; i++)
+    payload[i] = seq + i;
+  batch.append(msg, payload, count * sizeof(int));
+}
+
+void send_task(const void *args, size_t arglen,
+	       const void *userdata, size_t userlen, Processor p)
+{
+  size_t num_nodes = Machine::get_machine().get_address_space_count();
+  for(NodeID target = 0; target < NodeID(num_nodes); target++) {
+    ActiveMessageBatch batch(target, max_batch_size);
+    int seq = 0;
+    for(int b = 0; b < num_batches; b++) {
+      // the mix of handler kinds differs from batch to batch
+      for(int i = 0; i < batch_length; i++, seq++)
+	switch((seq + b) % 3) {
+	case 0: append_message<TimedMessage>(batch, seq); break;
+	case 1: append_message<PlainMessage>(batch, seq); break;
+	case 2: append_message<InlineMessage>(batch, seq); break;
+	}
+      batch.commit();
+    }
+  }
+}
+
+// the check task triggers the event it's given if everything arrived
+//  intact, or poisons it if not
+void check_task(const void *args, size_t arglen,
+		const void *userdata, size_t userlen, Processor p)
+{
+  assert(arglen == sizeof(UserEvent));
+  UserEvent result = *static_cast<const UserEvent *>(args);
+
+  size_t num_nodes = Machine::get_machine().get_address_space_count();
+  int expected = num_batches * batch_length;
+
+  // messages are handled asynchronously, so wait for them all to show up
+  long long t_limit = (Clock::current_time_in_nanoseconds() +
+		       max_wait_seconds * 1000000000LL);
+  bool done = false;
+  while(!done) {
+    {
+      AutoLock<> al(seq_mutex);
+      done = true;
+      for(NodeID sender = 0; sender < NodeID(num_nodes); sender++)
+	if(next_seq[sender] < expected)
+	  done = false;
+    }
+    if(done || (Clock::current_time_in_nanoseconds() > t_limit))
+      break;
+    usleep(1000);
+  }
+
+  bool ok = done;
+  AutoLock<> al(seq_mutex);
+  for(NodeID sender = 0; sender < NodeID(num_nodes); sender++)
+    if(next_seq[sender] != expected) {
+      log_app.error() << "node " << p.address_space() << ": received "
+		      << next_seq[sender] << " messages from node " << sender
+		      << " (expected " << expected << ")";
+      ok = false;
+    }
+  if((order_errors > 0) || (payload_errors > 0))
+    ok = false;
+
+  log_app.print() << "node " << p.address_space() << ": "
+		  << (ok ? "passed" : "FAILED");
+  if(ok)
+    result.trigger();
+  else
+    result.cancel();
+}
+
+void top_level_task(const void *args, size_t arglen,
+		    const void *userdata, size_t userlen, Processor p)
+{
+  size_t num_nodes = Machine::get_machine().get_address_space_count();
+  log_app.print() << "activemsg batch test: nodes=" << num_nodes
+		  << " batches=" << num_batches << " length=" << batch_length
+		  << " max_size=" << max_batch_size;
+
+  // one processor per node sends, then checks what it received
+  std::vector<Processor> procs;
+  {
+    Machine::ProcessorQuery pq(Machine::get_machine());
+    pq.only_kind(Processor::LOC_PROC);
+    std::vector<bool> seen(num_nodes, false);
+    for(Machine::ProcessorQuery::iterator it = pq.begin(); it != pq.end(); ++it)
+      if(!seen[it->address_space()]) {
+	seen[it->address_space()] = true;
+	procs.push_back(*it);
+      }
+  }
+
+  std::vector<Event> sent;
+  for(size_t i = 0; i < procs.size(); i++)
+    sent.push_back(procs[i].spawn(SEND_TASK, 0, 0));
+  Event all_sent = Event::merge_events(sent);
+
+  std::vector<UserEvent> results(procs.size());
+  for(size_t i = 0; i < procs.size(); i++) {
+    results[i] = UserEvent::create_user_event();
+    procs[i].spawn(CHECK_TASK, &results[i], sizeof(UserEvent), all_sent);
+  }
+
+  bool ok = true;
+  for(size_t i = 0; i < procs.size(); i++) {
+    bool poisoned = false;
+    results[i].wait_faultaware(poisoned);
+    if(poisoned)
+      ok = false;
+  }
+
+  if(ok)
+    log_app.print() << "activemsg batch test passed";
+
+  Runtime::get_runtime().shutdown(Event::NO_EVENT, ok ? 0 : 1);
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-b")) {
+      num_batches = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-l")) {
+      batch_length = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-s")) {
+      max_batch_size = strtoull(argv[++i], 0, 10);
+      continue;
+    }
+  }
+  assert((num_batches > 0) && (batch_length > 0));
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+  rt.register_task(SEND_TASK, send_task);
+  rt.register_task(CHECK_TASK, check_task);
+
+  Processor p = Machine::ProcessorQuery(Machine::get_machine())
+    .only_kind(Processor::LOC_PROC)
+    .first();
+  assert(p.exists());
+
+  // collective launch of a single main task
+  rt.collective_spawn(p, TOP_LEVEL_TASK, 0, 0);
+
+  // main task will call shutdown - wait for that and return the exit code
+  return rt.wait_for_shutdown();
+}
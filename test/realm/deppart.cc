@@ -2122,6 +2122,212 @@ int RandomTest<N1,T1,N2,T2,FT>::check_partitioning(void)
   return 0;
 }
 
+// throughput of by-field, image and preimage operations on one large
+//  instance - a single instance means a single micro-op per operation, so
+//  this measures how well one micro-op's scan spreads across the
+//  partitioning workers (see -dp:workers, -dp:chunk and -dp:maxchunks)
+class ThroughputTest : public TestInterface {
+public:
+  ThroughputTest(int argc, const char *argv[]);
+  virtual ~ThroughputTest(void);
+
+  virtual void print_info(void);
+
+  virtual Event initialize_data(const std::vector<Memory>& memories,
+				const std::vector<Processor>& procs);
+
+  virtual Event perform_partitioning(void);
+
+  virtual int perform_dynamic_checks(void);
+
+  virtual int check_partitioning(void);
+
+protected:
+  enum {
+    FID_COLOR = 0,
+    FID_PTR = sizeof(int),
+  };
+
+  int color_of(Point<2> p) const;
+  Point<2> ptr_of(Point<2> p) const;
+
+  // reports the average time and points per second over all repetitions
+  void report(const char *what, long long elapsed_ns) const;
+
+  int size_x, size_y, num_colors, num_reps;
+
+  IndexSpace<2> root;
+  RegionInstance inst;
+  std::vector<int> colors;
+  std::vector<FieldDataDescriptor<IndexSpace<2>, int> > fd_colors;
+  std::vector<FieldDataDescriptor<IndexSpace<2>, Point<2> > > fd_ptrs;
+  std::vector<IndexSpace<2> > ss_by_color, ss_images, ss_preimages;
+};
+
+ThroughputTest::ThroughputTest(int argc, const char *argv[])
+  : size_x(1024), size_y(1024), num_colors(8), num_reps(4)
+{
+#define INT_ARG(s, v) if(!strcmp(argv[i], s)) { v = atoi(argv[++i]); continue; }
+  for(int i = 1; i < argc; i++) {
+    INT_ARG("-x", size_x)
+    INT_ARG("-y", size_y)
+    INT_ARG("-c", num_colors)
+    INT_ARG("-r", num_reps)
+    if(!strcmp(argv[i], "-n")) { int v = atoi(argv[++i]); size_x = size_y = v; continue; }
+  }
+#undef INT_ARG
+  assert((size_x > 0) && (size_y > 0) && (num_colors > 0) && (num_reps > 0));
+}
+
+ThroughputTest::~ThroughputTest(void)
+{}
+
+void ThroughputTest::print_info(void)
+{
+  printf("Realm dependent partitioning test - throughput: %d x %d points, %d colors, %d reps\n",
+	 size_x, size_y, num_colors, num_reps);
+}
+
+// diagonal stripes 16 points wide, so each color is many rectangles
+int ThroughputTest::color_of(Point<2> p) const
+{
+  return ((p.x / 16) + (p.y / 16)) % num_colors;
+}
+
+// a shift along x with wraparound, which is a bijection on the root space
+Point<2> ThroughputTest::ptr_of(Point<2> p) const
+{
+  return Point<2>((p.x + 7) % size_x, p.y);
+}
+
+Event ThroughputTest::initialize_data(const std::vector<Memory>& memories,
+				      const std::vector<Processor>& procs)
+{
+  root = IndexSpace<2>(Rect<2>(Point<2>(0, 0), Point<2>(size_x - 1, size_y - 1)));
+
+  std::vector<size_t> field_sizes;
+  field_sizes.push_back(sizeof(int));
+  field_sizes.push_back(sizeof(Point<2>));
+  RegionInstance::create_instance(inst, memories[0], root, field_sizes,
+				  0 /*SOA*/, ProfilingRequestSet()).wait();
+  assert(inst.exists());
+
+  AffineAccessor<int,2> a_colors(inst, FID_COLOR);
+  AffineAccessor<Point<2>,2> a_ptrs(inst, FID_PTR);
+  for(PointInRectIterator<2> pir(root.bounds); pir.valid; pir.step()) {
+    a_colors.write(pir.p, color_of(pir.p));
+    a_ptrs.write(pir.p, ptr_of(pir.p));
+  }
+
+  colors.resize(num_colors);
+  for(int i = 0; i < num_colors; i++)
+    colors[i] = i;
+
+  fd_colors.resize(1);
+  fd_colors[0].index_space = root;
+  fd_colors[0].inst = inst;
+  fd_colors[0].field_offset = FID_COLOR;
+
+  fd_ptrs.resize(1);
+  fd_ptrs[0].index_space = root;
+  fd_ptrs[0].inst = inst;
+  fd_ptrs[0].field_offset = FID_PTR;
+
+  return Event::NO_EVENT;
+}
+
+void ThroughputTest::report(const char *what, long long elapsed_ns) const
+{
+  double points = double(root.volume()) * num_reps;
+  log_app.print() << what << ": " << (1e-6 * elapsed_ns / num_reps)
+		  << " ms/op, " << (1e3 * points / elapsed_ns) << " Mpoints/s";
+}
+
+static void destroy_spaces(std::vector<IndexSpace<2> >& spaces)
+{
+  for(size_t i = 0; i < spaces.size(); i++)
+    spaces[i].destroy();
+  spaces.clear();
+}
+
+Event ThroughputTest::perform_partitioning(void)
+{
+  // each kind of operation is timed on its own, waiting for each one, so
+  //  that only the micro-op's scan is measured
+  long long t_byfield = 0, t_image = 0, t_preimage = 0;
+  for(int r = 0; r < num_reps; r++) {
+    bool last = (r == (num_reps - 1));
+
+    long long t1 = Clock::current_time_in_nanoseconds();
+    root.create_subspaces_by_field(fd_colors, colors, ss_by_color,
+				   ProfilingRequestSet()).wait();
+    long long t2 = Clock::current_time_in_nanoseconds();
+    root.create_subspaces_by_image(fd_ptrs, ss_by_color, ss_images,
+				   ProfilingRequestSet()).wait();
+    long long t3 = Clock::current_time_in_nanoseconds();
+    root.create_subspaces_by_preimage(fd_ptrs, ss_by_color, ss_preimages,
+				      ProfilingRequestSet()).wait();
+    long long t4 = Clock::current_time_in_nanoseconds();
+
+    t_byfield += t2 - t1;
+    t_image += t3 - t2;
+    t_preimage += t4 - t3;
+
+    // keep the last repetition's results for checking
+    if(!last) {
+      destroy_spaces(ss_by_color);
+      destroy_spaces(ss_images);
+      destroy_spaces(ss_preimages);
+    }
+  }
+
+  report("byfield", t_byfield);
+  report("image", t_image);
+  report("preimage", t_preimage);
+
+  return Event::NO_EVENT;
+}
+
+int ThroughputTest::perform_dynamic_checks(void)
+{
+  return 0;
+}
+
+int ThroughputTest::check_partitioning(void)
+{
+  int errors = 0;
+
+  for(int i = 0; i < num_colors; i++) {
+    ss_by_color[i].make_valid().wait();
+    ss_images[i].make_valid().wait();
+    ss_preimages[i].make_valid().wait();
+  }
+
+  for(PointInRectIterator<2> pir(root.bounds); pir.valid; pir.step()) {
+    int c = color_of(pir.p);
+    int c2 = color_of(ptr_of(pir.p));
+    for(int i = 0; i < num_colors; i++) {
+      bool exp_byfield = (i == c);
+      // 'ptr_of' is a bijection, so 'p' is in image 'i' exactly when its
+      //  source point is in color 'i'
+      bool exp_image = (i == color_of(Point<2>((pir.p.x + size_x - 7) % size_x,
+					      pir.p.y)));
+      bool exp_preimage = (i == c2);
+      if((ss_by_color[i].contains(pir.p) != exp_byfield) ||
+	 (ss_images[i].contains(pir.p) != exp_image) ||
+	 (ss_preimages[i].contains(pir.p) != exp_preimage)) {
+	if(errors++ < 10)
+	  log_app.error() << "mismatch: point=" << pir.p << " color=" << i
+			  << " byfield=" << ss_by_color[i].contains(pir.p)
+			  << " image=" << ss_images[i].contains(pir.p)
+			  << " preimage=" << ss_preimages[i].contains(pir.p);
+      }
+    }
+  }
+
+  return errors;
+}
+
 void top_level_task(const void *args, size_t arglen,
 		    const void *userdata, size_t userlen, Processor p)
 {
@@ -2677,6 +2883,11 @@ int main(int argc, char **argv) {
       break;
     }
 
+    if (!strcmp(argv[i], "throughput")) {
+      testcfg = new ThroughputTest(argc - i, const_cast<const char **>(argv + i));
+      break;
+    }
+
     if (!strcmp(argv[i], "random")) {
       testcfg = new RandomTest<1, int, 2, int, int>(
           argc - i, const_cast<const char **>(argv + i));
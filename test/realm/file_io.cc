@@ -0,0 +1,192 @@
+#include "realm.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+
+#include <unistd.h>
+
+#include "osdep.h"
+
+using namespace Realm;
+
+Logger log_app("app");
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+};
+
+enum {
+  FID_A = 0,
+  FID_B = 1,
+};
+
+size_t num_elements = 1 << 18;
+std::string file_dir = "/tmp";
+
+static RegionInstance create_sysmem_instance(Memory m, Rect<1> bounds)
+{
+  std::map<FieldID, size_t> field_sizes;
+  field_sizes[FID_A] = sizeof(int);
+  field_sizes[FID_B] = sizeof(double);
+
+  RegionInstance inst;
+  RegionInstance::create_instance(inst, m, bounds, field_sizes,
+				  0 /*SOA*/, ProfilingRequestSet()).wait();
+  assert(inst.exists());
+  return inst;
+}
+
+static void copy_fields(Rect<1> bounds, RegionInstance src, RegionInstance dst)
+{
+  std::vector<CopySrcDstField> srcs(2), dsts(2);
+  srcs[0].set_field(src, FID_A, sizeof(int));
+  srcs[1].set_field(src, FID_B, sizeof(double));
+  dsts[0].set_field(dst, FID_A, sizeof(int));
+  dsts[1].set_field(dst, FID_B, sizeof(double));
+  bounds.copy(srcs, dsts, ProfilingRequestSet()).wait();
+}
+
+// copies data out to 'io_inst' and back into a fresh instance, checking
+//  that it survives the round trip
+static bool round_trip(const char *what, Memory sysmem, Rect<1> bounds,
+		       RegionInstance src_inst, RegionInstance io_inst)
+{
+  RegionInstance dst_inst = create_sysmem_instance(sysmem, bounds);
+
+  long long t1 = Clock::current_time_in_nanoseconds();
+  copy_fields(bounds, src_inst, io_inst);
+  long long t2 = Clock::current_time_in_nanoseconds();
+  copy_fields(bounds, io_inst, dst_inst);
+  long long t3 = Clock::current_time_in_nanoseconds();
+
+  size_t errors = 0;
+  AffineAccessor<int, 1> acc_a(dst_inst, FID_A);
+  AffineAccessor<double, 1> acc_b(dst_inst, FID_B);
+  for(int i = bounds.lo[0]; i <= bounds.hi[0]; i++)
+    if((acc_a[i] != (3 * i + 1)) || (acc_b[i] != (0.5 * i))) {
+      if(errors++ < 10)
+	log_app.error() << what << ": mismatch at " << i << ": "
+			<< acc_a[i] << " " << acc_b[i];
+    }
+
+  double bytes = double(bounds.volume()) * (sizeof(int) + sizeof(double));
+  log_app.print() << what << ": write=" << (bytes / (t2 - t1)) << " GB/s"
+		  << " read=" << (bytes / (t3 - t2)) << " GB/s"
+		  << " errors=" << errors;
+
+  dst_inst.destroy();
+  return (errors == 0);
+}
+
+void top_level_task(const void *args, size_t arglen,
+		    const void *userdata, size_t userlen, Processor p)
+{
+  log_app.print() << "file i/o test: elements=" << num_elements;
+
+  Memory sysmem = Machine::MemoryQuery(Machine::get_machine())
+    .only_kind(Memory::SYSTEM_MEM)
+    .best_affinity_to(p)
+    .first();
+  assert(sysmem.exists());
+
+  Rect<1> bounds(0, num_elements - 1);
+  RegionInstance src_inst = create_sysmem_instance(sysmem, bounds);
+  {
+    AffineAccessor<int, 1> acc_a(src_inst, FID_A);
+    AffineAccessor<double, 1> acc_b(src_inst, FID_B);
+    for(int i = bounds.lo[0]; i <= bounds.hi[0]; i++) {
+      acc_a[i] = 3 * i + 1;
+      acc_b[i] = 0.5 * i;
+    }
+  }
+
+  bool ok = true;
+
+  // file memory, through an external file resource
+  {
+    std::string filename = (file_dir + "/realm_file_io_" +
+			    std::to_string(getpid()) + ".dat");
+
+    std::map<FieldID, size_t> field_sizes;
+    field_sizes[FID_A] = sizeof(int);
+    field_sizes[FID_B] = sizeof(double);
+    InstanceLayoutConstraints ilc(field_sizes, 0 /*SOA*/);
+    int dim_order[1] = { 0 };
+    InstanceLayoutGeneric *ilg =
+      InstanceLayoutGeneric::choose_instance_layout<1, int>(bounds, ilc,
+							     dim_order);
+
+    ExternalFileResource res(filename, LEGION_FILE_CREATE);
+    RegionInstance file_inst;
+    RegionInstance::create_external_instance(file_inst,
+					     res.suggested_memory(),
+					     ilg, res,
+					     ProfilingRequestSet()).wait();
+    assert(file_inst.exists());
+
+    ok &= round_trip("file", sysmem, bounds, src_inst, file_inst);
+
+    file_inst.destroy();
+    unlink(filename.c_str());
+  }
+
+  // disk memory, if one was requested with -ll:dsize
+  {
+    Memory diskmem = Machine::MemoryQuery(Machine::get_machine())
+      .only_kind(Memory::DISK_MEM)
+      .has_capacity(bounds.volume() * (sizeof(int) + sizeof(double)))
+      .first();
+    if(diskmem.exists()) {
+      RegionInstance disk_inst = create_sysmem_instance(diskmem, bounds);
+      ok &= round_trip("disk", sysmem, bounds, src_inst, disk_inst);
+      disk_inst.destroy();
+    } else
+      log_app.print() << "no disk memory - skipping disk test";
+  }
+
+  src_inst.destroy();
+
+  if(ok)
+    log_app.print() << "file i/o test passed";
+
+  Runtime::get_runtime().shutdown(Event::NO_EVENT, ok ? 0 : 1);
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-n")) {
+      num_elements = strtoull(argv[++i], 0, 10);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-dir")) {
+      file_dir = argv[++i];
+      continue;
+    }
+  }
+  assert(num_elements > 0);
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+
+  Processor p = Machine::ProcessorQuery(Machine::get_machine())
+    .only_kind(Processor::LOC_PROC)
+    .first();
+  assert(p.exists());
+
+  // collective launch of a single main task
+  rt.collective_spawn(p, TOP_LEVEL_TASK, 0, 0);
+
+  // main task will call shutdown - wait for that and return the exit code
+  return rt.wait_for_shutdown();
+}
@@ -0,0 +1,226 @@
+#include "realm.h"
+
+#include <vector>
+
+#include "osdep.h"
+
+using namespace Realm;
+
+Logger log_app("app");
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+};
+
+int num_iterations = 100000;
+size_t max_live_instances = 4096;
+unsigned random_seed = 12345;
+
+// a small LCG so the sequence of sizes and victims is reproducible
+static unsigned next_random(unsigned& state)
+{
+  state = state * 1103515245 + 12345;
+  return (state >> 8);
+}
+
+static RegionInstance create_mixed_instance(Memory m, unsigned& state)
+{
+  // mix of tiny, medium, and occasional large instances so the free space
+  //  fragments in lots of different ways
+  static const size_t base_sizes[] = { 1, 7, 64, 100, 1000, 4096, 10000 };
+  const size_t num_sizes = sizeof(base_sizes) / sizeof(base_sizes[0]);
+  size_t elems = base_sizes[next_random(state) % num_sizes];
+  elems += next_random(state) % (elems + 1);
+
+  Rect<1> bounds(0, elems - 1);
+  std::vector<size_t> field_sizes(1, (next_random(state) & 1) ? 8 : 4);
+
+  RegionInstance inst;
+  Event e = RegionInstance::create_instance(inst, m, bounds, field_sizes,
+					    0 /*SOA*/, ProfilingRequestSet());
+  e.wait();
+  assert(inst.exists());
+  return inst;
+}
+
+// all sizes used by the placement checks are multiples of this, so
+//  instance alignment never adds padding between them
+static const size_t BLOCK = 4096;
+
+static RegionInstance create_block_instance(Memory m, size_t blocks)
+{
+  Rect<1> bounds(0, blocks * BLOCK - 1);
+  std::vector<size_t> field_sizes(1, 1);
+
+  RegionInstance inst;
+  Event e = RegionInstance::create_instance(inst, m, bounds, field_sizes,
+					    0 /*SOA*/, ProfilingRequestSet());
+  e.wait();
+  assert(inst.exists());
+  return inst;
+}
+
+static uintptr_t block_address(RegionInstance inst)
+{
+  return reinterpret_cast<uintptr_t>(inst.pointer_untyped(0, BLOCK));
+}
+
+// deterministic checks of the placement decisions made by the memory's
+//  allocator - these have to run before the churn fragments the memory
+static bool check_placement(Memory m)
+{
+  // lay out A=4 B=1 C=2 D=1 E=8 F=1 blocks back to back, with F keeping
+  //  E's space from merging with the free space at the end
+  static const size_t sizes[] = { 4, 1, 2, 1, 8, 1 };
+  const size_t count = sizeof(sizes) / sizeof(sizes[0]);
+  RegionInstance insts[count];
+  uintptr_t addrs[count];
+  for(size_t i = 0; i < count; i++) {
+    insts[i] = create_block_instance(m, sizes[i]);
+    addrs[i] = block_address(insts[i]);
+    if((i > 0) && (addrs[i] != (addrs[i - 1] + sizes[i - 1] * BLOCK))) {
+      log_app.error() << "placement: memory not empty - instance " << i
+		      << " is not adjacent to the previous one";
+      for(size_t j = 0; j <= i; j++)
+	insts[j].destroy();
+      return false;
+    }
+  }
+
+  bool ok = true;
+  std::vector<RegionInstance> extra;
+
+  // leave holes of 4 (A), 2 (C), and 8 (E) blocks
+  insts[0].destroy();
+  insts[2].destroy();
+  insts[4].destroy();
+
+  // best fit picks the smallest hole that's big enough, not the first one
+  struct { size_t blocks; uintptr_t expected; const char *what; } fits[] = {
+    { 1, addrs[2], "1 block into the 2 block hole" },
+    { 3, addrs[0], "3 blocks into the 4 block hole" },
+    { 6, addrs[4], "6 blocks into the 8 block hole" },
+  };
+  for(size_t i = 0; i < sizeof(fits) / sizeof(fits[0]); i++) {
+    RegionInstance inst = create_block_instance(m, fits[i].blocks);
+    extra.push_back(inst);
+    if(block_address(inst) != fits[i].expected) {
+      log_app.error() << "placement: best fit failed for " << fits[i].what;
+      ok = false;
+    }
+  }
+
+  // freeing B has to merge the 1 block left over from A's hole with B's
+  //  space - the merged 2 block hole is then the best fit for a 2 block
+  //  instance (the 2 block remainder of E's hole comes later in memory)
+  insts[1].destroy();
+  {
+    RegionInstance inst = create_block_instance(m, 2);
+    extra.push_back(inst);
+    if(block_address(inst) != (addrs[0] + 3 * BLOCK)) {
+      log_app.error() << "placement: freed neighbours were not coalesced";
+      ok = false;
+    }
+  }
+
+  insts[3].destroy();
+  insts[5].destroy();
+  for(size_t i = 0; i < extra.size(); i++)
+    extra[i].destroy();
+
+  // with everything freed, the whole area is one range again
+  {
+    RegionInstance inst = create_block_instance(m, 17);
+    if(block_address(inst) != addrs[0]) {
+      log_app.error() << "placement: freed ranges were not fully coalesced";
+      ok = false;
+    }
+    inst.destroy();
+  }
+
+  return ok;
+}
+
+void top_level_task(const void *args, size_t arglen,
+		    const void *userdata, size_t userlen, Processor p)
+{
+  log_app.print() << "instance churn: iterations=" << num_iterations
+		  << " max_live=" << max_live_instances;
+
+  Memory m = Machine::MemoryQuery(Machine::get_machine())
+    .only_kind(Memory::SYSTEM_MEM)
+    .best_affinity_to(p)
+    .first();
+  assert(m.exists());
+
+  bool ok = check_placement(m);
+  if(ok)
+    log_app.print() << "allocator placement checks passed";
+
+  unsigned state = random_seed;
+  std::vector<RegionInstance> live;
+  live.reserve(max_live_instances);
+
+  // fill up to the live limit first
+  while(live.size() < max_live_instances)
+    live.push_back(create_mixed_instance(m, state));
+
+  // then replace a random live instance on each iteration
+  long long t_start = Clock::current_time_in_nanoseconds();
+  for(int i = 0; i < num_iterations; i++) {
+    size_t victim = next_random(state) % live.size();
+    live[victim].destroy();
+    live[victim] = create_mixed_instance(m, state);
+  }
+  long long t_end = Clock::current_time_in_nanoseconds();
+
+  for(size_t i = 0; i < live.size(); i++)
+    live[i].destroy();
+
+  double elapsed = 1e-9 * (t_end - t_start);
+  log_app.print() << "churned " << num_iterations << " instances in "
+		  << elapsed << " s ("
+		  << (1e6 * elapsed / (num_iterations ? num_iterations : 1))
+		  << " us/instance)";
+
+  Runtime::get_runtime().shutdown(Event::NO_EVENT, ok ? 0 : 1);
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-i")) {
+      num_iterations = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-m")) {
+      max_live_instances = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-seed")) {
+      random_seed = atoi(argv[++i]);
+      continue;
+    }
+  }
+  assert(max_live_instances > 0);
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+
+  Processor p = Machine::ProcessorQuery(Machine::get_machine())
+    .only_kind(Processor::LOC_PROC)
+    .first();
+  assert(p.exists());
+
+  // collective launch of a single main task
+  rt.collective_spawn(p, TOP_LEVEL_TASK, 0, 0);
+
+  // main task will call shutdown - wait for that and return the exit code
+  return rt.wait_for_shutdown();
+}
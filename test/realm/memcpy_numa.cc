@@ -0,0 +1,160 @@
+#include "realm.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <vector>
+#include <map>
+
+#include "osdep.h"
+
+using namespace Realm;
+
+Logger log_app("app");
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+};
+
+enum {
+  FID_DATA = 0,
+};
+
+// measures the throughput of many concurrent copies between each pair of
+//  cpu-accessible memories (system and numa memories) - run with
+//  -ll:bgnuma/-ll:bgnumapin and compare -ll:memcpy_numa 1 (copies queued
+//  by numa domain) against -ll:memcpy_numa 0 (one queue for all copies)
+size_t copy_size = 16 << 20;
+int num_copies = 8;
+int num_reps = 4;
+
+static RegionInstance create_instance(Memory m, size_t elements)
+{
+  std::map<FieldID, size_t> field_sizes;
+  field_sizes[FID_DATA] = sizeof(int);
+
+  RegionInstance inst;
+  RegionInstance::create_instance(inst, m, Rect<1>(0, elements - 1),
+				  field_sizes, 0 /*SOA*/,
+				  ProfilingRequestSet()).wait();
+  return inst;
+}
+
+static bool copy_between(Memory src_mem, Memory dst_mem)
+{
+  size_t elements = copy_size / sizeof(int);
+  Rect<1> bounds(0, elements - 1);
+
+  std::vector<RegionInstance> srcs(num_copies), dsts(num_copies);
+  for(int i = 0; i < num_copies; i++) {
+    srcs[i] = create_instance(src_mem, elements);
+    dsts[i] = create_instance(dst_mem, elements);
+    assert(srcs[i].exists() && dsts[i].exists());
+
+    AffineAccessor<int, 1> acc(srcs[i], FID_DATA);
+    for(size_t e = 0; e < elements; e++)
+      acc[e] = int(e) + i;
+  }
+
+  long long t_total = 0;
+  for(int r = 0; r < num_reps; r++) {
+    std::vector<Event> done(num_copies);
+    long long t_start = Clock::current_time_in_nanoseconds();
+    for(int i = 0; i < num_copies; i++) {
+      std::vector<CopySrcDstField> src_fields(1), dst_fields(1);
+      src_fields[0].set_field(srcs[i], FID_DATA, sizeof(int));
+      dst_fields[0].set_field(dsts[i], FID_DATA, sizeof(int));
+      done[i] = bounds.copy(src_fields, dst_fields, ProfilingRequestSet());
+    }
+    Event::merge_events(done).wait();
+    t_total += Clock::current_time_in_nanoseconds() - t_start;
+  }
+
+  size_t errors = 0;
+  for(int i = 0; i < num_copies; i++) {
+    AffineAccessor<int, 1> acc(dsts[i], FID_DATA);
+    for(size_t e = 0; e < elements; e++)
+      if(acc[e] != (int(e) + i)) {
+	if(errors++ < 10)
+	  log_app.error() << "mismatch: copy=" << i << " index=" << e
+			  << " actual=" << acc[e];
+      }
+    srcs[i].destroy();
+    dsts[i].destroy();
+  }
+
+  double bytes = double(copy_size) * num_copies * num_reps;
+  log_app.print() << src_mem << " (" << src_mem.kind() << ") -> "
+		  << dst_mem << " (" << dst_mem.kind() << "): "
+		  << (bytes / t_total) << " GB/s";
+
+  return (errors == 0);
+}
+
+void top_level_task(const void *args, size_t arglen,
+		    const void *userdata, size_t userlen, Processor p)
+{
+  log_app.print() << "memcpy numa test: size=" << copy_size
+		  << " copies=" << num_copies << " reps=" << num_reps;
+
+  // a copy within a memory needs room for both sides
+  std::vector<Memory> mems;
+  {
+    Machine::MemoryQuery mq(Machine::get_machine());
+    mq.local_address_space().has_capacity(2 * num_copies * copy_size);
+    for(Machine::MemoryQuery::iterator it = mq.begin(); it != mq.end(); ++it)
+      if(((*it).kind() == Memory::SYSTEM_MEM) ||
+	 ((*it).kind() == Memory::SOCKET_MEM))
+	mems.push_back(*it);
+  }
+
+  bool ok = true;
+  for(size_t i = 0; i < mems.size(); i++)
+    for(size_t j = 0; j < mems.size(); j++)
+      ok &= copy_between(mems[i], mems[j]);
+
+  if(ok)
+    log_app.print() << "memcpy numa test passed";
+
+  Runtime::get_runtime().shutdown(Event::NO_EVENT, ok ? 0 : 1);
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-s")) {
+      copy_size = size_t(strtoull(argv[++i], 0, 10)) << 20;
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-c")) {
+      num_copies = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-r")) {
+      num_reps = atoi(argv[++i]);
+      continue;
+    }
+  }
+  assert((copy_size > 0) && (num_copies > 0) && (num_reps > 0));
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+
+  Processor p = Machine::ProcessorQuery(Machine::get_machine())
+    .only_kind(Processor::LOC_PROC)
+    .first();
+  assert(p.exists());
+
+  // collective launch of a single main task
+  rt.collective_spawn(p, TOP_LEVEL_TASK, 0, 0);
+
+  // main task will call shutdown - wait for that and return the exit code
+  return rt.wait_for_shutdown();
+}
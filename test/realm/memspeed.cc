@@ -1,6 +1,7 @@
 #include "realm.h"
 #include "realm/id.h"
 #include "realm/cmdline.h"
+#include "realm/transfer/memcpy_kernels.h"
 
 #include <cstdio>
 #include <cstdlib>
@@ -68,6 +69,7 @@ namespace TestConfig {
   size_t sparse_gap = 16;   // gap between sparse chunks (if used)
   bool copy_aos = false;   // if true, use an AOS memory layout
   bool slow_mems = false;  // show slow memories be tested?
+  bool copy_kernels = false;  // repeat copies with each memcpy kernel?
 };
 
 void memspeed_cpu_task(const void *args, size_t arglen, 
@@ -374,10 +376,6 @@ void top_level_task(const void *args, size_t arglen,
           d.copy(srcs, dsts, ProfilingRequestSet()).wait();
         }
 
-	long long total_full_copy_time = 0;
-	long long total_short_copy_time = 0;
-        long long total_sparse_copy_time = 0;
-
         std::vector<CopySrcDstField> srcs(TestConfig::copy_fields);
         for(int i = 0; i < TestConfig::copy_fields; i++)
           srcs[i].set_field(inst1, FID_BASE+i, sizeof(void *));
@@ -385,86 +383,113 @@ void top_level_task(const void *args, size_t arglen,
         for(int i = 0; i < TestConfig::copy_fields; i++)
           dsts[i].set_field(inst2, FID_BASE+i, sizeof(void *));
 
-	for(int rep = 0; rep <= TestConfig::copy_reps; rep++) {
-	  // now perform two instance-to-instance copies
-
-	  // copy #1 - full copy
-	  long long full_copy_time = -1;
-	  UserEvent full_copy_done = UserEvent::create_user_event();
-	  {
-	    CopyProfResult result;
-	    result.nanoseconds = &full_copy_time;
-	    result.done = full_copy_done;
-	    ProfilingRequestSet prs;
-	    prs.add_request(p, COPYPROF_TASK, &result, sizeof(CopyProfResult))
-	      .add_measurement<ProfilingMeasurements::OperationTimeline>();
-	    d.copy(srcs, dsts, prs).wait();
+        // either just the default kernel, or every one this cpu supports
+        //  (only affects copies performed by this process)
+        MemcpyKernels::Variant orig_kernel = MemcpyKernels::get_selected();
+        std::vector<MemcpyKernels::Variant> kernels;
+        if(TestConfig::copy_kernels) {
+          for(int k = MemcpyKernels::VARIANT_AUTO;
+              k < MemcpyKernels::NUM_VARIANTS;
+              k++)
+            if(MemcpyKernels::is_supported(MemcpyKernels::Variant(k)))
+              kernels.push_back(MemcpyKernels::Variant(k));
+        } else
+          kernels.push_back(orig_kernel);
+
+        for(size_t kidx = 0; kidx < kernels.size(); kidx++) {
+	  MemcpyKernels::set_selected(kernels[kidx]);
+
+	  long long total_full_copy_time = 0;
+	  long long total_short_copy_time = 0;
+	  long long total_sparse_copy_time = 0;
+
+	  for(int rep = 0; rep <= TestConfig::copy_reps; rep++) {
+	    // now perform two instance-to-instance copies
+
+	    // copy #1 - full copy
+	    long long full_copy_time = -1;
+	    UserEvent full_copy_done = UserEvent::create_user_event();
+	    {
+	      CopyProfResult result;
+	      result.nanoseconds = &full_copy_time;
+	      result.done = full_copy_done;
+	      ProfilingRequestSet prs;
+	      prs.add_request(p, COPYPROF_TASK, &result, sizeof(CopyProfResult))
+		.add_measurement<ProfilingMeasurements::OperationTimeline>();
+	      d.copy(srcs, dsts, prs).wait();
+	    }
+
+	    // copy #2 - single-element copy
+	    long long short_copy_time = -1;
+	    UserEvent short_copy_done = UserEvent::create_user_event();
+	    {
+	      CopyProfResult result;
+	      result.nanoseconds = &short_copy_time;
+	      result.done = short_copy_done;
+	      ProfilingRequestSet prs;
+	      prs.add_request(p, COPYPROF_TASK, &result, sizeof(CopyProfResult))
+		.add_measurement<ProfilingMeasurements::OperationTimeline>();
+	      Rect<1>(0, 0).copy(srcs, dsts, prs).wait();
+	    }
+
+	    // wait for both results
+	    full_copy_done.wait();
+	    short_copy_done.wait();
+
+	    if((rep > 0) || (TestConfig::copy_reps == 0)) {
+	      total_full_copy_time += full_copy_time;
+	      total_short_copy_time += short_copy_time;
+	    }
+
+	    // optional copy #3 - sparse copy
+	    if(TestConfig::sparse_chunk > 0) {
+	      long long sparse_copy_time = -1;
+	      UserEvent sparse_copy_done = UserEvent::create_user_event();
+	      {
+		CopyProfResult result;
+		result.nanoseconds = &sparse_copy_time;
+		result.done = sparse_copy_done;
+		ProfilingRequestSet prs;
+		prs.add_request(p, COPYPROF_TASK, &result, sizeof(CopyProfResult))
+		  .add_measurement<ProfilingMeasurements::OperationTimeline>();
+		d_sparse.copy(srcs, dsts, prs).wait();
+	      }
+
+	      sparse_copy_done.wait();
+
+	      if((rep > 0) || (TestConfig::copy_reps == 0))
+		total_sparse_copy_time += sparse_copy_time;
+	    }
 	  }
 
-	  // copy #2 - single-element copy
-	  long long short_copy_time = -1;
-	  UserEvent short_copy_done = UserEvent::create_user_event();
-	  {
-	    CopyProfResult result;
-	    result.nanoseconds = &short_copy_time;
-	    result.done = short_copy_done;
-	    ProfilingRequestSet prs;
-	    prs.add_request(p, COPYPROF_TASK, &result, sizeof(CopyProfResult))
-	      .add_measurement<ProfilingMeasurements::OperationTimeline>();
-	    Rect<1>(0, 0).copy(srcs, dsts, prs).wait();
+	  if(TestConfig::copy_reps > 1) {
+	    total_full_copy_time /= TestConfig::copy_reps;
+	    total_short_copy_time /= TestConfig::copy_reps;
+	    total_sparse_copy_time /= TestConfig::copy_reps;
 	  }
 
-	  // wait for both results
-	  full_copy_done.wait();
-	  short_copy_done.wait();
-
-	  if((rep > 0) || (TestConfig::copy_reps == 0)) {
-	    total_full_copy_time += full_copy_time;
-	    total_short_copy_time += short_copy_time;
+	  // latency is estimated as time to perfom single copy
+	  double latency = total_short_copy_time;
+
+	  // bandwidth is estimated based on extra time taken by full copy
+	  double bw = (1.0 * elements * TestConfig::copy_fields * sizeof(void *) /
+		       (total_full_copy_time - total_short_copy_time));
+
+	  if(TestConfig::copy_kernels) {
+	    // bytes per nanosecond is GB/s
+	    log_app.print() << "copy " << m1 << " -> " << m2
+			    << ": kernel=" << MemcpyKernels::variant_name(kernels[kidx])
+			    << " bw=" << bw << " GB/s lat=" << latency << " ns";
+	  } else if(TestConfig::sparse_chunk == 0) {
+	    log_app.info() << "copy " << m1 << " -> " << m2 << ": bw:" << bw << " lat:" << latency;
+	  } else {
+	    double sparse_bw = (1.0 * sparse_elements * TestConfig::copy_fields * sizeof(void *) /
+				(total_sparse_copy_time - total_short_copy_time));
+
+	    log_app.info() << "copy " << m1 << " -> " << m2 << ": bw:" << bw << " lat:" << latency << " sparse_bw:" << sparse_bw;
 	  }
-
-          // optional copy #3 - sparse copy
-          if(TestConfig::sparse_chunk > 0) {
-            long long sparse_copy_time = -1;
-            UserEvent sparse_copy_done = UserEvent::create_user_event();
-            {
-              CopyProfResult result;
-              result.nanoseconds = &sparse_copy_time;
-              result.done = sparse_copy_done;
-              ProfilingRequestSet prs;
-              prs.add_request(p, COPYPROF_TASK, &result, sizeof(CopyProfResult))
-                .add_measurement<ProfilingMeasurements::OperationTimeline>();
-              d_sparse.copy(srcs, dsts, prs).wait();
-            }
-
-            sparse_copy_done.wait();
-
-            if((rep > 0) || (TestConfig::copy_reps == 0))
-              total_sparse_copy_time += sparse_copy_time;
-          }
-	}
-
-	if(TestConfig::copy_reps > 1) {
-	  total_full_copy_time /= TestConfig::copy_reps;
-	  total_short_copy_time /= TestConfig::copy_reps;
-          total_sparse_copy_time /= TestConfig::copy_reps;
-	}
-
-	// latency is estimated as time to perfom single copy
-	double latency = total_short_copy_time;
-
-	// bandwidth is estimated based on extra time taken by full copy
-	double bw = (1.0 * elements * TestConfig::copy_fields * sizeof(void *) /
-		     (total_full_copy_time - total_short_copy_time));
-
-        if(TestConfig::sparse_chunk == 0) {
-          log_app.info() << "copy " << m1 << " -> " << m2 << ": bw:" << bw << " lat:" << latency;
-        } else {
-          double sparse_bw = (1.0 * sparse_elements * TestConfig::copy_fields * sizeof(void *) /
-                              (total_sparse_copy_time - total_short_copy_time));
-
-          log_app.info() << "copy " << m1 << " -> " << m2 << ": bw:" << bw << " lat:" << latency << " sparse_bw:" << sparse_bw;
         }
+        MemcpyKernels::set_selected(orig_kernel);
 
 	inst2.destroy();
       }
@@ -492,7 +517,8 @@ int main(int argc, char **argv)
     .add_option_int("-sparse", TestConfig::sparse_chunk)
     .add_option_int("-gap", TestConfig::sparse_gap)
     .add_option_int("-aos", TestConfig::copy_aos)
-    .add_option_int("-slowmem", TestConfig::slow_mems);
+    .add_option_int("-slowmem", TestConfig::slow_mems)
+    .add_option_int("-kernels", TestConfig::copy_kernels);
   bool ok = cp.parse_command_line(argc, const_cast<const char **>(argv));
   assert(ok);
 
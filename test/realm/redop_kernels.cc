@@ -0,0 +1,246 @@
+#include "realm.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+#include "osdep.h"
+
+using namespace Realm;
+
+Logger log_app("app");
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+};
+
+size_t num_elements = 1 << 16;
+int num_reps = 10;
+
+// the same shapes as the built-in Legion sum/prod/min/max ops
+template <typename T>
+class SumOp {
+public:
+  typedef T LHS;
+  typedef T RHS;
+  static const T identity;
+  static const bool is_vectorizable = true;
+
+  template <bool EXCL>
+  static void apply(LHS& lhs, RHS rhs) { lhs += rhs; }
+  template <bool EXCL>
+  static void fold(RHS& rhs1, RHS rhs2) { rhs1 += rhs2; }
+};
+template <typename T> const T SumOp<T>::identity = 0;
+
+template <typename T>
+class ProdOp {
+public:
+  typedef T LHS;
+  typedef T RHS;
+  static const T identity;
+  static const bool is_vectorizable = true;
+
+  template <bool EXCL>
+  static void apply(LHS& lhs, RHS rhs) { lhs *= rhs; }
+  template <bool EXCL>
+  static void fold(RHS& rhs1, RHS rhs2) { rhs1 *= rhs2; }
+};
+template <typename T> const T ProdOp<T>::identity = 1;
+
+template <typename T>
+class MinOp {
+public:
+  typedef T LHS;
+  typedef T RHS;
+  static const T identity;
+  static const bool is_vectorizable = true;
+
+  template <bool EXCL>
+  static void apply(LHS& lhs, RHS rhs) { if(rhs < lhs) lhs = rhs; }
+  template <bool EXCL>
+  static void fold(RHS& rhs1, RHS rhs2) { if(rhs2 < rhs1) rhs1 = rhs2; }
+};
+template <typename T> const T MinOp<T>::identity = 127;
+
+template <typename T>
+class MaxOp {
+public:
+  typedef T LHS;
+  typedef T RHS;
+  static const T identity;
+  static const bool is_vectorizable = true;
+
+  template <bool EXCL>
+  static void apply(LHS& lhs, RHS rhs) { if(rhs > lhs) lhs = rhs; }
+  template <bool EXCL>
+  static void fold(RHS& rhs1, RHS rhs2) { if(rhs2 > rhs1) rhs1 = rhs2; }
+};
+template <typename T> const T MaxOp<T>::identity = -127;
+
+// no is_vectorizable - must keep the generic kernels
+class PlainSumOp {
+public:
+  typedef int LHS;
+  typedef int RHS;
+  static const int identity;
+
+  template <bool EXCL>
+  static void apply(LHS& lhs, RHS rhs) { lhs += rhs; }
+  template <bool EXCL>
+  static void fold(RHS& rhs1, RHS rhs2) { rhs1 += rhs2; }
+};
+const int PlainSumOp::identity = 0;
+
+// small values so that products don't overflow or lose precision
+template <typename T>
+static T test_value(size_t i, unsigned salt)
+{
+  return T(int((i * 7 + salt * 13) % 5) - 2);
+}
+
+template <typename OP>
+static bool check_kernels(const char *name)
+{
+  typedef typename OP::LHS T;
+  ReductionOp<OP> redop_obj;
+  const ReductionOpUntyped *redop = &redop_obj;
+  bool ok = true;
+
+  if(redop->cpu_apply_excl_fn == &ReductionKernels::cpu_apply_wrapper<OP, true>) {
+    log_app.error() << name << ": vectorized apply kernel not selected";
+    ok = false;
+  }
+
+  // dense apply/fold against a plain loop, then again with a stride of 3 to
+  //  make sure the fallback path is still taken correctly
+  for(size_t stride = 1; stride <= 3; stride += 2) {
+    size_t n = num_elements;
+    std::vector<T> lhs(n * stride), rhs(n * stride), ref(n * stride);
+    for(size_t i = 0; i < n * stride; i++) {
+      lhs[i] = ref[i] = test_value<T>(i, 1);
+      rhs[i] = test_value<T>(i, 2);
+    }
+
+    (redop->cpu_apply_excl_fn)(lhs.data(), stride * sizeof(T),
+                               rhs.data(), stride * sizeof(T),
+                               n, redop->userdata);
+    for(size_t i = 0; i < n; i++)
+      OP::template apply<true>(ref[i * stride], rhs[i * stride]);
+    for(size_t i = 0; i < n * stride; i++)
+      if(lhs[i] != ref[i]) {
+        log_app.error() << name << ": apply mismatch: stride=" << stride
+                        << " index=" << i;
+        ok = false;
+        break;
+      }
+
+    (redop->cpu_fold_excl_fn)(lhs.data(), stride * sizeof(T),
+                              rhs.data(), stride * sizeof(T),
+                              n, redop->userdata);
+    for(size_t i = 0; i < n; i++)
+      OP::template fold<true>(ref[i * stride], rhs[i * stride]);
+    for(size_t i = 0; i < n * stride; i++)
+      if(lhs[i] != ref[i]) {
+        log_app.error() << name << ": fold mismatch: stride=" << stride
+                        << " index=" << i;
+        ok = false;
+        break;
+      }
+  }
+
+  // compare speed of dense vectorized and scalar exclusive applies
+  {
+    size_t n = num_elements;
+    std::vector<T> lhs(n, OP::identity), rhs(n);
+    for(size_t i = 0; i < n; i++)
+      rhs[i] = test_value<T>(i, 3);
+
+    long long t1 = Clock::current_time_in_nanoseconds();
+    for(int r = 0; r < num_reps; r++)
+      (redop->cpu_apply_excl_fn)(lhs.data(), sizeof(T), rhs.data(), sizeof(T),
+                                 n, redop->userdata);
+    long long t2 = Clock::current_time_in_nanoseconds();
+    for(int r = 0; r < num_reps; r++)
+      ReductionKernels::cpu_apply_wrapper<OP, true>(lhs.data(), sizeof(T),
+                                                    rhs.data(), sizeof(T),
+                                                    n, redop->userdata);
+    long long t3 = Clock::current_time_in_nanoseconds();
+
+    double elems = double(n) * num_reps;
+    log_app.print() << name << ": vectorized=" << (elems / (t2 - t1))
+                    << " Gelem/s scalar=" << (elems / (t3 - t2)) << " Gelem/s";
+  }
+
+  return ok;
+}
+
+void top_level_task(const void *args, size_t arglen,
+		    const void *userdata, size_t userlen, Processor p)
+{
+  log_app.print() << "reduction kernels: elements=" << num_elements
+                  << " reps=" << num_reps;
+
+  bool ok = true;
+  ok &= check_kernels<SumOp<int> >("sum<int>");
+  ok &= check_kernels<SumOp<long long> >("sum<long long>");
+  ok &= check_kernels<SumOp<float> >("sum<float>");
+  ok &= check_kernels<SumOp<double> >("sum<double>");
+  ok &= check_kernels<ProdOp<int> >("prod<int>");
+  ok &= check_kernels<ProdOp<float> >("prod<float>");
+  ok &= check_kernels<ProdOp<double> >("prod<double>");
+  ok &= check_kernels<MinOp<int> >("min<int>");
+  ok &= check_kernels<MinOp<float> >("min<float>");
+  ok &= check_kernels<MinOp<double> >("min<double>");
+  ok &= check_kernels<MaxOp<int> >("max<int>");
+  ok &= check_kernels<MaxOp<float> >("max<float>");
+  ok &= check_kernels<MaxOp<double> >("max<double>");
+
+  {
+    ReductionOp<PlainSumOp> redop;
+    if(redop.cpu_apply_excl_fn != &ReductionKernels::cpu_apply_wrapper<PlainSumOp, true>) {
+      log_app.error() << "vectorized kernel used for op without is_vectorizable";
+      ok = false;
+    }
+  }
+
+  if(ok)
+    log_app.print() << "all reduction kernels correct";
+
+  Runtime::get_runtime().shutdown(Event::NO_EVENT, ok ? 0 : 1);
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-n")) {
+      num_elements = strtoull(argv[++i], 0, 10);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-r")) {
+      num_reps = atoi(argv[++i]);
+      continue;
+    }
+  }
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+
+  Processor p = Machine::ProcessorQuery(Machine::get_machine())
+    .only_kind(Processor::LOC_PROC)
+    .first();
+  assert(p.exists());
+
+  // collective launch of a single main task
+  rt.collective_spawn(p, TOP_LEVEL_TASK, 0, 0);
+
+  // main task will call shutdown - wait for that and return the exit code
+  return rt.wait_for_shutdown();
+}
@@ -39,6 +39,7 @@ namespace TestConfig {
   int random_seed = 12345;
   int max_holes = 3;
   bool verbose = false;
+  int bench_size = 0; // 0 = skip the query benchmarks
 };
 
 class PRNG {
@@ -281,6 +282,140 @@ bool test_dim(int& seed)
   return true;
 }
 
+// a 2x2 block at every 4th point in each dimension, offset by 'shift', so
+//  nothing merges and there are (size/4)^2 entries
+static IndexSpace<2> make_blocks(int size, int shift)
+{
+  std::vector<Rect<2> > rects;
+  for(int y = 0; y < size; y += 4)
+    for(int x = 0; x < size; x += 4)
+      rects.push_back(Rect<2>(Point<2>(x + shift, y + shift),
+			      Point<2>(x + shift + 1, y + shift + 1)));
+  IndexSpace<2> is(rects, true /*disjoint*/);
+  is.make_valid().wait();
+  return is;
+}
+
+static bool in_blocks(int x, int y, int shift)
+{
+  return ((x >= shift) && (y >= shift) &&
+	  (((x - shift) % 4) < 2) && (((y - shift) % 4) < 2));
+}
+
+static double usec_since(long long t_start)
+{
+  return 1e-3 * (Clock::current_time_in_nanoseconds() - t_start);
+}
+
+// times queries against large sparse spaces, checking their answers against
+//  the known layout of the blocks
+bool bench_queries(int size)
+{
+  bool ok = true;
+
+  long long t_start = Clock::current_time_in_nanoseconds();
+  IndexSpace<2> is = make_blocks(size, 0);
+  IndexSpace<2> is_apart = make_blocks(size, 2);  // fills the gaps in 'is'
+  IndexSpace<2> is_near = make_blocks(size, 1);   // overlaps one point per block
+  size_t num_entries = is.sparsity.impl()->get_entries().size();
+  log_app.print() << "query bench: size=" << size << " entries=" << num_entries
+		  << " construct=" << (usec_since(t_start) / 3) << " us";
+
+  // contains() on every point of the bounds - the first call also builds
+  //  the entry index
+  {
+    t_start = Clock::current_time_in_nanoseconds();
+    size_t errors = 0;
+    size_t queries = 0;
+    for(PointInRectIterator<2> pir(is.bounds); pir.valid; pir.step(), queries++)
+      if(is.contains(pir.p) != in_blocks(pir.p.x, pir.p.y, 0))
+	errors++;
+    double us = usec_since(t_start);
+    log_app.print() << "contains: " << queries << " queries, "
+		    << (1e3 * us / queries) << " ns/query, errors=" << errors;
+    ok &= (errors == 0);
+  }
+
+  // contains_any()/contains_all() on 3x3 windows
+  {
+    t_start = Clock::current_time_in_nanoseconds();
+    size_t errors = 0;
+    size_t queries = 0;
+    for(int y = 0; y < size - 2; y += 3)
+      for(int x = 0; x < size - 2; x += 3, queries++) {
+	Rect<2> r(Point<2>(x, y), Point<2>(x + 2, y + 2));
+	bool exp_any = false, exp_all = true;
+	for(PointInRectIterator<2> pir(r); pir.valid; pir.step()) {
+	  bool b = in_blocks(pir.p.x, pir.p.y, 0);
+	  exp_any |= b;
+	  exp_all &= b;
+	}
+	if((is.contains_any(r) != exp_any) || (is.contains_all(r) != exp_all))
+	  errors++;
+      }
+    double us = usec_since(t_start);
+    log_app.print() << "contains_any/all: " << queries << " queries, "
+		    << (1e3 * us / queries) << " ns/query, errors=" << errors;
+    ok &= (errors == 0);
+  }
+
+  // restricted iteration over 8x8 windows
+  {
+    t_start = Clock::current_time_in_nanoseconds();
+    size_t errors = 0;
+    size_t queries = 0;
+    for(int y = 0; y < size; y += 8)
+      for(int x = 0; x < size; x += 8, queries++) {
+	Rect<2> r(Point<2>(x, y), Point<2>(x + 7, y + 7));
+	size_t volume = 0;
+	for(IndexSpaceIterator<2> it(is, r); it.valid; it.step())
+	  volume += it.rect.volume();
+	// each 8x8 window holds four whole blocks
+	if(volume != 16)
+	  errors++;
+      }
+    double us = usec_since(t_start);
+    log_app.print() << "restricted iterator: " << queries << " windows, "
+		    << (1e3 * us / queries) << " ns/window, errors=" << errors;
+    ok &= (errors == 0);
+  }
+
+  // overlap tests and intersections between pairs of large spaces
+  {
+    t_start = Clock::current_time_in_nanoseconds();
+    bool ov_apart = is.overlaps(is_apart);
+    bool ov_near = is.overlaps(is_near);
+    double us = usec_since(t_start);
+    log_app.print() << "overlaps: " << (us / 2) << " us/query";
+    if(ov_apart || !ov_near) {
+      log_app.error() << "overlaps mismatch: apart=" << ov_apart
+		      << " near=" << ov_near;
+      ok = false;
+    }
+
+    t_start = Clock::current_time_in_nanoseconds();
+    IndexSpace<2> isect;
+    IndexSpace<2>::compute_intersection(is, is_near, isect,
+					ProfilingRequestSet()).wait();
+    size_t volume = isect.volume();
+    us = usec_since(t_start);
+    log_app.print() << "intersection: " << us << " us, volume=" << volume;
+    // one point of each block in 'is' is covered by 'is_near'
+    size_t exp_volume = num_entries;
+    if(volume != exp_volume) {
+      log_app.error() << "intersection mismatch: volume=" << volume
+		      << " expected=" << exp_volume;
+      ok = false;
+    }
+    isect.destroy();
+  }
+
+  is.destroy();
+  is_apart.destroy();
+  is_near.destroy();
+  return ok;
+}
+
 void top_level_task(const void *args, size_t arglen, 
 		    const void *userdata, size_t userlen, Processor p)
 {
@@ -296,6 +431,8 @@ void top_level_task(const void *args, size_t arglen,
     ok = false;
   if(ok && ((TestConfig::dim_mask & 4) != 0) && !test_dim<3>(seed))
     ok = false;
+  if(ok && (TestConfig::bench_size > 0) && !bench_queries(TestConfig::bench_size))
+    ok = false;
 
   if(ok)
     log_app.info() << "sparse_construct test finished successfully";
@@ -319,6 +456,7 @@ int main(int argc, char **argv)
   cp.add_option_int("-seed", TestConfig::random_seed);
   cp.add_option_int("-grid", TestConfig::log2_maxgrid);
   cp.add_option_bool("-verbose", TestConfig::verbose);
+  cp.add_option_int("-bench", TestConfig::bench_size);
   bool ok = cp.parse_command_line(argc, const_cast<const char **>(argv));
   assert(ok);
   
@@ -0,0 +1,222 @@
+#include "realm.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <vector>
+#include <atomic>
+
+#include "osdep.h"
+
+using namespace Realm;
+
+Logger log_app("app");
+
+// Task IDs, some IDs are reserved so start at first available number
+enum {
+  TOP_LEVEL_TASK = Processor::TASK_ID_FIRST_AVAILABLE+0,
+  CHAIN_TASK,
+};
+
+int num_iterations = 10000;
+int graph_width = 4;
+int graph_depth = 4;
+
+struct ChainTaskArgs {
+  int iteration, level, column;
+};
+
+// each column of the graph is a chain of tasks, so every task can check
+//  that it runs right after its predecessor in the same column
+std::atomic<int> *column_progress = 0;
+std::atomic<int> order_errors(0);
+
+void chain_task(const void *args, size_t arglen,
+		const void *userdata, size_t userlen, Processor p)
+{
+  const ChainTaskArgs& cargs = *static_cast<const ChainTaskArgs *>(args);
+  int expected = cargs.iteration * graph_depth + cargs.level;
+  int actual = column_progress[cargs.column].fetch_add(1);
+  if(actual != expected) {
+    if(order_errors.fetch_add(1) == 0)
+      log_app.error() << "out of order: iteration=" << cargs.iteration
+		      << " level=" << cargs.level << " column=" << cargs.column
+		      << " progress=" << actual;
+  }
+}
+
+static bool check_progress(const char *what)
+{
+  bool ok = (order_errors.load() == 0);
+  for(int w = 0; w < graph_width; w++) {
+    int progress = column_progress[w].load();
+    if(progress != num_iterations * graph_depth) {
+      log_app.error() << what << ": column " << w << " ran " << progress
+		      << " tasks (expected " << (num_iterations * graph_depth) << ")";
+      ok = false;
+    }
+    column_progress[w].store(0);
+  }
+  order_errors.store(0);
+  return ok;
+}
+
+// each iteration is a graph of (width x depth) small tasks - every task in a
+//  level depends on the task in the same column of the previous level, and
+//  the first level of an iteration depends on the whole previous iteration
+static Event run_plain_graph(Processor p, int iteration, Event wait_on)
+{
+  std::vector<Event> prev(graph_width, wait_on), cur(graph_width);
+  for(int d = 0; d < graph_depth; d++) {
+    for(int w = 0; w < graph_width; w++) {
+      ChainTaskArgs cargs;
+      cargs.iteration = iteration;
+      cargs.level = d;
+      cargs.column = w;
+      cur[w] = p.spawn(CHAIN_TASK, &cargs, sizeof(cargs), prev[w]);
+    }
+    prev.swap(cur);
+  }
+  return Event::merge_events(prev);
+}
+
+static Subgraph create_replay_subgraph(Processor p)
+{
+  SubgraphDefinition sd;
+  sd.tasks.resize(graph_width * graph_depth);
+  sd.interpolations.resize(graph_width * graph_depth);
+  for(int i = 0; i < graph_width * graph_depth; i++) {
+    ChainTaskArgs cargs;
+    cargs.iteration = -1; // interpolated from the instantiation args
+    cargs.level = i / graph_width;
+    cargs.column = i % graph_width;
+    sd.tasks[i].proc = p;
+    sd.tasks[i].task_id = CHAIN_TASK;
+    sd.tasks[i].args.set(&cargs, sizeof(cargs));
+
+    sd.interpolations[i].offset = 0;
+    sd.interpolations[i].bytes = sizeof(int);
+    sd.interpolations[i].target_kind = SubgraphDefinition::Interpolation::TARGET_TASK_ARGS;
+    sd.interpolations[i].target_index = i;
+    sd.interpolations[i].target_offset = 0; // ChainTaskArgs::iteration
+    sd.interpolations[i].redop_id = 0;
+  }
+
+  for(int d = 1; d < graph_depth; d++)
+    for(int w = 0; w < graph_width; w++) {
+      SubgraphDefinition::Dependency dep;
+      dep.src_op_kind = SubgraphDefinition::OPKIND_TASK;
+      dep.src_op_index = (d - 1) * graph_width + w;
+      dep.tgt_op_kind = SubgraphDefinition::OPKIND_TASK;
+      dep.tgt_op_index = d * graph_width + w;
+      sd.dependencies.push_back(dep);
+    }
+
+  Subgraph sg;
+  Subgraph::create_subgraph(sg, sd, ProfilingRequestSet()).wait();
+  return sg;
+}
+
+void top_level_task(const void *args, size_t arglen,
+		    const void *userdata, size_t userlen, Processor p)
+{
+  log_app.print() << "subgraph replay: iterations=" << num_iterations
+		  << " width=" << graph_width << " depth=" << graph_depth;
+
+  // tasks go to a different processor if there is one so that launch
+  //  overhead isn't hidden behind task execution
+  Processor target = p;
+  {
+    Machine::ProcessorQuery pq(Machine::get_machine());
+    pq.only_kind(Processor::LOC_PROC).local_address_space();
+    for(Machine::ProcessorQuery::iterator it = pq.begin(); it != pq.end(); ++it)
+      if(*it != p) {
+	target = *it;
+	break;
+      }
+  }
+
+  double ops = double(num_iterations) * graph_width * graph_depth;
+  column_progress = new std::atomic<int>[graph_width];
+  for(int w = 0; w < graph_width; w++)
+    column_progress[w].store(0);
+  bool ok = true;
+
+  // plain task graph, built from scratch on every iteration
+  double plain_rate;
+  {
+    long long t_start = Clock::current_time_in_nanoseconds();
+    Event e = Event::NO_EVENT;
+    for(int i = 0; i < num_iterations; i++)
+      e = run_plain_graph(target, i, e);
+    e.wait();
+    long long t_end = Clock::current_time_in_nanoseconds();
+    plain_rate = ops / (1e-9 * (t_end - t_start));
+    ok &= check_progress("plain task graph");
+  }
+
+  // the same graph replayed through a subgraph
+  double replay_rate;
+  {
+    Subgraph sg = create_replay_subgraph(target);
+
+    long long t_start = Clock::current_time_in_nanoseconds();
+    Event e = Event::NO_EVENT;
+    for(int i = 0; i < num_iterations; i++)
+      e = sg.instantiate(&i, sizeof(i), ProfilingRequestSet(), e);
+    e.wait();
+    long long t_end = Clock::current_time_in_nanoseconds();
+    replay_rate = ops / (1e-9 * (t_end - t_start));
+    ok &= check_progress("subgraph replay");
+
+    sg.destroy();
+  }
+
+  log_app.print() << "plain task graph: " << plain_rate << " ops/s";
+  log_app.print() << "subgraph replay:  " << replay_rate << " ops/s ("
+		  << (replay_rate / plain_rate) << "x)";
+
+  delete[] column_progress;
+
+  Runtime::get_runtime().shutdown(Event::NO_EVENT, ok ? 0 : 1);
+}
+
+int main(int argc, char **argv)
+{
+  Runtime rt;
+
+  rt.init(&argc, &argv);
+
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-i")) {
+      num_iterations = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-w")) {
+      graph_width = atoi(argv[++i]);
+      continue;
+    }
+
+    if(!strcmp(argv[i], "-d")) {
+      graph_depth = atoi(argv[++i]);
+      continue;
+    }
+  }
+  assert((graph_width > 0) && (graph_depth > 0));
+
+  rt.register_task(TOP_LEVEL_TASK, top_level_task);
+  rt.register_task(CHAIN_TASK, chain_task);
+
+  Processor p = Machine::ProcessorQuery(Machine::get_machine())
+    .only_kind(Processor::LOC_PROC)
+    .first();
+  assert(p.exists());
+
+  // collective launch of a single main task
+  rt.collective_spawn(p, TOP_LEVEL_TASK, 0, 0);
+
+  // main task will call shutdown - wait for that and return the exit code
+  return rt.wait_for_shutdown();
+}
@@ -93,6 +93,8 @@ namespace TestConfig {
   size_t max_perms = 10;
   unsigned random_seed = 12345; // used to sample permutations if needed
   bool wait_after = false; // wait after each copy?
+  int num_fields = 0; // fields for AOS<->SOA experiments (0 = skip them)
+  int field_reps = 4; // timed repetitions of each AOS<->SOA copy
 };
 
 template <int N, typename FT>
@@ -229,6 +231,98 @@ void do_single_dim(Memory src_mem, Memory dst_mem, int log2_size,
   }
 }
 
+// copies a multi-field instance between AOS and SOA layouts (in all four
+//  combinations), checking the result and reporting the throughput
+template <typename FT>
+void do_field_layouts(Memory src_mem, Memory dst_mem, int num_fields,
+                      Processor prof_proc)
+{
+  size_t elements = TestConfig::buffer_size / (num_fields * sizeof(FT));
+  Rect<1> bounds(0, elements - 1);
+  std::map<FieldID, size_t> field_sizes;
+  for(int f = 0; f < num_fields; f++)
+    field_sizes[f] = sizeof(FT);
+
+  static const char *layout_names[2] = { "soa", "aos" };
+
+  for(int src_aos = 0; src_aos < 2; src_aos++)
+    for(int dst_aos = 0; dst_aos < 2; dst_aos++) {
+      // block_size: 0 = SOA, 1 = AOS
+      RegionInstance src_inst, dst_inst;
+      RegionInstance::create_instance(src_inst, src_mem, bounds, field_sizes,
+                                      src_aos, ProfilingRequestSet()).wait();
+      RegionInstance::create_instance(dst_inst, dst_mem, bounds, field_sizes,
+                                      dst_aos, ProfilingRequestSet()).wait();
+
+      // source values are unique per element and field so any mixup shows
+      //  up in the check below
+      bool check = (src_mem.kind() == Memory::SYSTEM_MEM) &&
+                   (dst_mem.kind() == Memory::SYSTEM_MEM);
+      if(check) {
+        for(int f = 0; f < num_fields; f++) {
+          AffineAccessor<FT,1> acc(src_inst, f);
+          for(size_t i = 0; i < elements; i++)
+            acc[i] = FT(i * num_fields + f);
+        }
+      }
+
+      std::vector<CopySrcDstField> srcs(num_fields), dsts(num_fields);
+      for(int f = 0; f < num_fields; f++) {
+        srcs[f].set_field(src_inst, f, sizeof(FT));
+        dsts[f].set_field(dst_inst, f, sizeof(FT));
+      }
+
+      long long total_time = 0;
+      for(int rep = 0; rep <= TestConfig::field_reps; rep++) {
+        long long copy_time = -1;
+        UserEvent done = UserEvent::create_user_event();
+        CopyProfResult cpr;
+        cpr.nanoseconds = &copy_time;
+        cpr.done = done;
+        ProfilingRequestSet prs;
+        prs.add_request(prof_proc, COPYPROF_TASK, &cpr, sizeof(CopyProfResult))
+          .add_measurement<ProfilingMeasurements::OperationTimeline>();
+        bounds.copy(srcs, dsts, prs).wait();
+        done.wait();
+        // first copy is a warmup (page faults, etc.)
+        if((rep > 0) || (TestConfig::field_reps == 0))
+          total_time += copy_time;
+      }
+      if(TestConfig::field_reps > 1)
+        total_time /= TestConfig::field_reps;
+
+      if(check) {
+        size_t errors = 0;
+        for(int f = 0; f < num_fields; f++) {
+          AffineAccessor<FT,1> acc(dst_inst, f);
+          for(size_t i = 0; i < elements; i++)
+            if(acc[i] != FT(i * num_fields + f)) {
+              if(errors++ < 10)
+                log_app.error() << "mismatch: field=" << f << " elem=" << i
+                                << " exp=" << FT(i * num_fields + f)
+                                << " act=" << acc[i];
+            }
+        }
+        if(errors > 0) {
+          log_app.fatal() << "layout copy " << layout_names[src_aos] << "->"
+                          << layout_names[dst_aos] << ": " << errors
+                          << " errors";
+          abort();
+        }
+      }
+
+      double bw = 1.0 * elements * num_fields * sizeof(FT) / total_time;
+      log_app.print() << "fields=" << num_fields
+                      << " src=" << layout_names[src_aos]
+                      << " dst=" << layout_names[dst_aos]
+                      << " time=" << (1e-9 * total_time)
+                      << " bw=" << bw;
+
+      src_inst.destroy();
+      dst_inst.destroy();
+    }
+}
+
 std::set<Processor::Kind> supported_proc_kinds;
 
 void top_level_task(const void *args, size_t arglen, 
@@ -278,6 +372,8 @@ void top_level_task(const void *args, size_t arglen,
         ++dst_it) {
       log_app.print() << "srcmem=" << *src_it << " dstmem=" << *dst_it;
       typedef int FT;
+      if(TestConfig::num_fields > 0)
+        do_field_layouts<FT>(*src_it, *dst_it, TestConfig::num_fields, p);
       if((TestConfig::dim_mask & 1) != 0)
         do_single_dim<1, FT>(*src_it, *dst_it, log2_buffer_size, 0, p);
       if((TestConfig::dim_mask & 2) != 0)
@@ -333,7 +429,9 @@ int main(int argc, char **argv)
     .add_option_int("-pad", TestConfig::pad_width)
     .add_option_int("-perms", TestConfig::max_perms)
     .add_option_int("-seed", TestConfig::random_seed)
-    .add_option_int("-wait", TestConfig::wait_after);
+    .add_option_int("-wait", TestConfig::wait_after)
+    .add_option_int("-fields", TestConfig::num_fields)
+    .add_option_int("-freps", TestConfig::field_reps);
   bool ok = cp.parse_command_line(argc, const_cast<const char **>(argv));
   assert(ok);
 